@@ -0,0 +1,129 @@
+"""
+Replay of a test captured by the ESP32 (src/SampleLog.h)
+
+Download /data/result/<name>.bin (the last run of a result) or
+/data/last_test.bin (a test not saved) from the system page and run:
+    python replay.py last_test.bin            # summary + rupture window
+    python replay.py last_test.bin --csv out  # all the samples to out.csv
+    python replay.py last_test.bin --factor -52236.7  # recalibrated (counts/kg)
+
+Only the window of the peak, the samples as they were saved. The bins of the
+result (the whole grid, the alignment, the properties) come from the code of
+the firmware itself: mytests/native/replay.cpp, pio run -e replay.
+The force is stored in net counts (src/Calibration.h), the factor of the
+header converts it to kg and a new factor can be applied to an old capture.
+"""
+import struct
+import sys
+
+HEADER = struct.Struct('<4sHHIiqfI')
+VERSION = 2
+BLOCK_HEAD = struct.Struct('<IIq')
+SAMPLE = struct.Struct('<ifi')
+
+# TestAnalyzer.h
+TEST_START_TIME = -200
+TEST_END_TIME = 100
+TEST_STEP_TIME = 20
+
+
+def read_log(path, factor=None):
+    """Returns header dict and a list of (time_us, distance, force kg)"""
+    with open(path, 'rb') as f:
+        data = f.read()
+
+    magic, version, block_samples, rate, offset, zero, log_factor, _ = HEADER.unpack_from(data, 0)
+    if magic != b'PTLG' or version != VERSION:
+        raise ValueError('not a SampleLog file, or an old version')
+
+    header = {'version': version, 'block_samples': block_samples,
+              'sample_rate': rate, 'zero_time': zero,
+              'offset': offset, 'factor': log_factor}
+    # net counts are positive under tension, only the magnitude applies
+    counts_per_kg = abs(factor if factor else log_factor)
+    block_size = BLOCK_HEAD.size + block_samples * SAMPLE.size
+
+    samples = []
+    pos = HEADER.size
+    while pos + block_size <= len(data):
+        index, count, base = BLOCK_HEAD.unpack_from(data, pos)
+        for i in range(min(count, block_samples)):
+            t, d, counts = SAMPLE.unpack_from(data, pos + BLOCK_HEAD.size + i * SAMPLE.size)
+            samples.append((base + t, d, counts / counts_per_kg))
+        pos += block_size
+    return header, samples
+
+
+class Resampler:
+    """Merge walk of src/Resampler.h, targets in ascending order"""
+
+    def __init__(self, samples):
+        self.samples = samples
+        self.index = 0
+
+    def seek(self, target):
+        s = self.samples
+        while self.index < len(s) and s[self.index][0] <= target:
+            self.index += 1
+        prev = min(max(self.index - 1, 0), len(s) - 2)
+        self.prev, self.next = s[prev], s[prev + 1]
+        self.target = target
+
+    def interpolate(self, col):
+        span = self.next[0] - self.prev[0]
+        if span == 0:
+            return self.prev[col]
+        slope = (self.next[col] - self.prev[col]) / span
+        return self.prev[col] + slope * (self.target - self.prev[0])
+
+
+def rupture_window(samples):
+    # first maximum, like the running peak of TestAnalyzer
+    peak = samples[0]
+    for s in samples:
+        if s[2] > peak[2]:
+            peak = s
+    rows = []
+    walk = Resampler(samples)
+    for rel in range(TEST_START_TIME, TEST_END_TIME + 1, TEST_STEP_TIME):
+        walk.seek(peak[0] + rel * 1000)
+        d = walk.interpolate(1)
+        fz = max(0.0, walk.interpolate(2))
+        rows.append((rel, d, fz))
+    return peak, rows
+
+
+def main():
+    if len(sys.argv) < 2:
+        print(__doc__)
+        return
+
+    factor = None
+    if '--factor' in sys.argv:
+        factor = float(sys.argv[sys.argv.index('--factor') + 1])
+    header, samples = read_log(sys.argv[1], factor)
+    print(header)
+    if len(samples) < 2:
+        print('not enough samples')
+        return
+
+    duration = (samples[-1][0] - samples[0][0]) / 1e6
+    print(f'{len(samples)} samples, {duration:.1f}s')
+
+    if '--csv' in sys.argv:
+        out = sys.argv[sys.argv.index('--csv') + 1] + '.csv'
+        with open(out, 'w') as f:
+            f.write('time_us,distance,force\n')
+            for t, d, fz in samples:
+                f.write(f'{t},{d:.4f},{fz:.3f}\n')
+        print('saved', out)
+
+    peak, rows = rupture_window(samples)
+    print(f'rupture {peak[2]:.2f}kg at {peak[0] / 1000:.1f}ms {peak[1]:.3f}mm')
+    print('   t |      d |     f')
+    for rel, d, fz in rows:
+        print(f'{rel:4d} | {d:6.3f} | {fz:5.2f}')
+
+
+if __name__ == '__main__':
+    main()
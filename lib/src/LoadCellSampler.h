@@ -0,0 +1,230 @@
+/**
+ * @file LoadCellSampler.h
+ * @brief Interrupt driven HX711 acquisition running in its own FreeRTOS task.
+ */
+#ifndef LOADCELL_SAMPLER_H
+#define LOADCELL_SAMPLER_H
+
+#include "Arduino.h"
+#include "HX711.h"
+#include <SampleRing.h>
+#include <functional>
+
+/**
+ * @brief One raw conversion of the HX711.
+ */
+struct LoadCellSample
+{
+    int64_t time = 0;      ///< esp_timer time (us) when DOUT went low.
+    int32_t raw = 0;       ///< Raw 24-bit count, sign extended.
+    float position = 0.0f; ///< Position latched when the task woke up for this conversion.
+};
+
+/**
+ * @class LoadCellSampler
+ * @brief Captures every HX711 conversion, independent of what loop() is doing.
+ *
+ * The HX711 pulls DOUT low when a new conversion is ready. A falling edge
+ * interrupt timestamps that moment and wakes a task pinned to the other core,
+ * which clocks the 24 bits out and pushes the sample into a lock-free ring.
+ * loop() drains the ring with pop() whenever it gets the chance, so slow
+ * LittleFS writes or JSON building no longer drop load cell samples.
+ *
+ * While the task clocks the data out DOUT toggles with the data bits, the ISR
+ * ignores those edges until the task re-arms it after the read.
+ *
+ * An optional position source (e.g. the stepper position) is read by the task
+ * as soon as it is woken, a few microseconds after the edge, so force and
+ * distance of a sample belong to the same instant.
+ *
+ * An optional sample callback runs in the task for every conversion, before
+ * loop() sees it, for the checks that can't wait (break, overload).
+ *
+ * Usage:
+ *   1. scale.begin(dout, sck) as usual.
+ *   2. sampler.begin(scale, dout) to start the acquisition task.
+ *   3. Call pop() from loop() until it returns false.
+ *
+ * @note After begin() the HX711 must only be read by the sampler task.
+ */
+class LoadCellSampler
+{
+public:
+    // ~3s of samples at 80hz
+    static const uint32_t RING_SIZE = 256;
+
+    /**
+     * @brief Callback that returns the position to latch with each sample.
+     * @note It runs in the sampler task, it must be safe to call from another core.
+     */
+    typedef std::function<float()> PositionCallback;
+
+    /**
+     * @brief Callback called by the sampler task with every new sample.
+     * @note It runs in the sampler task, keep it short and safe to call from another core.
+     */
+    typedef std::function<void(const LoadCellSample &sample)> SampleCallback;
+
+    /**
+     * @brief Starts the acquisition task and the data ready interrupt.
+     * @param scale The HX711 instance, already initialized with begin().
+     * @param dout_pin The pin connected to the HX711 DOUT signal.
+     * @param core The core where the task is pinned (loop() runs on core 1).
+     * @param priority The FreeRTOS priority of the task.
+     * @return True if the task was created, false otherwise.
+     */
+    bool begin(HX711 &scale, uint8_t dout_pin, BaseType_t core = 0,
+               UBaseType_t priority = configMAX_PRIORITIES - 5)
+    {
+        hx711 = &scale;
+        doutPin = dout_pin;
+
+        BaseType_t ok = xTaskCreatePinnedToCore(
+            taskLoop, "loadcell", 4096, this, priority, &task, core);
+
+        if (ok != pdPASS)
+        {
+            Serial.println("LoadCellSampler task not created!");
+            return false;
+        }
+
+        attachInterruptArg(digitalPinToInterrupt(doutPin), onDataReady, this, FALLING);
+        Serial.printf("LoadCellSampler started on core %d\n", core);
+        return true;
+    }
+
+    /**
+     * @brief Sets the source of the position latched with every sample.
+     * @param callback The function returning the current position.
+     * @note Call it before begin(), the task reads it without locking.
+     */
+    void setPositionSource(PositionCallback callback)
+    {
+        positionSource = callback;
+    }
+
+    /**
+     * @brief Sets the function called by the task for every sample.
+     * @param callback The function receiving each sample, right after the read.
+     * @note Call it before begin(), the task reads it without locking.
+     */
+    void setOnSample(SampleCallback callback)
+    {
+        onSample = callback;
+    }
+
+    /**
+     * @brief Takes the oldest pending sample (call only from loop()).
+     * @param sample Receives the sample.
+     * @return True if a sample was available, false otherwise.
+     */
+    bool pop(LoadCellSample &sample)
+    {
+        return ring.pop(sample);
+    }
+
+    /**
+     * @brief Discards the samples waiting in the ring.
+     */
+    void clear()
+    {
+        ring.clear();
+    }
+
+    /**
+     * @brief Gets the number of samples waiting in the ring.
+     * @return The number of pending samples.
+     */
+    uint32_t available()
+    {
+        return ring.size();
+    }
+
+    /**
+     * @brief Gets the number of samples lost because loop() did not drain the ring.
+     * @return The overrun counter since start.
+     */
+    uint32_t getDropped()
+    {
+        return ring.getDropped();
+    }
+
+    /**
+     * @brief Gets the total number of conversions read by the task.
+     * @return The sample counter since start.
+     */
+    uint32_t getCount()
+    {
+        return count;
+    }
+
+private:
+    HX711 *hx711 = nullptr;
+    uint8_t doutPin = 0;
+    TaskHandle_t task = nullptr;
+    SampleRing<LoadCellSample, RING_SIZE> ring;
+    PositionCallback positionSource;
+    SampleCallback onSample;
+
+    // Set by the task when it waits for the next conversion, cleared by the ISR.
+    volatile bool armed = true;
+    // Time of the last DOUT falling edge.
+    volatile int64_t readyTime = 0;
+    volatile uint32_t count = 0;
+
+    /**
+     * @brief DOUT falling edge, a new conversion is ready.
+     */
+    static void IRAM_ATTR onDataReady(void *arg)
+    {
+        LoadCellSampler *self = static_cast<LoadCellSampler *>(arg);
+        if (!self->armed)
+            return;
+
+        self->armed = false;
+        self->readyTime = esp_timer_get_time();
+
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(self->task, &woken);
+        if (woken)
+            portYIELD_FROM_ISR();
+    }
+
+    /**
+     * @brief Acquisition task, reads one conversion per notification.
+     */
+    static void taskLoop(void *arg)
+    {
+        LoadCellSampler *self = static_cast<LoadCellSampler *>(arg);
+        // at 80hz a conversion takes 12.5ms, the timeout only covers a lost edge
+        const TickType_t timeout = pdMS_TO_TICKS(50);
+
+        for (;;)
+        {
+            bool notified = ulTaskNotifyTake(pdTRUE, timeout) > 0;
+
+            if (!self->hx711->is_ready())
+            {
+                self->armed = true;
+                continue;
+            }
+
+            LoadCellSample sample;
+            sample.time = notified ? self->readyTime : esp_timer_get_time();
+            // latch before clocking the bits out, the read takes ~100us
+            if (self->positionSource)
+                sample.position = self->positionSource();
+            sample.raw = self->hx711->read();
+
+            self->ring.push(sample);
+            self->count++;
+            if (self->onSample)
+                self->onSample(sample);
+
+            // DOUT is high again after the 25th clock, wait for the next edge
+            self->armed = true;
+        }
+    }
+};
+
+#endif
@@ -173,7 +173,11 @@ public:
     }
 
     /**
-     * @brief Immediately stops the motor.
+     * @brief Immediately stops the motor, no deceleration ramp.
+     *
+     * The position is kept. It only queues the stop in FastAccelStepper, so
+     * it can be called from the sampler task (break, overload), loop() then
+     * sees the end of the motion in checkLimit().
      */
     void emergencyStop()
     {
@@ -10,13 +10,66 @@
  * NetworkManager class handles WiFi connectivity for ESP devices
  * It provides functionality for both Access Point (AP) and Station (STA) modes
  * Includes DNS server capabilities for captive portal functionality
+ *
+ * The STA connection never blocks: connect() only starts it and update()
+ * drives a state machine (connect, timeout, retry, reconnect when lost),
+ * the changes are reported by the status callback.
  */
 class NetworkManager
 {
 
+public:
+    enum Status : uint8_t
+    {
+        DISCONNECTED = 0, // lost or stopped
+        CONNECTING,       // WiFi.begin() sent, waiting the IP
+        CONNECTED,
+        FAILED            // timeout, retried after RETRY_TIME
+    };
+    typedef std::function<void(Status status)> StatusCallback;
+
+    static const uint32_t CONNECT_TIMEOUT = 20000; // ms
+    static const uint32_t RETRY_TIME = 60000;      // ms after a timeout
+    static const uint32_t RESTART_DELAY = 1000;    // ms after a disconnect
+
 private:
+    enum State : uint8_t
+    {
+        IDLE,       // no STA
+        STARTING,   // waiting RESTART_DELAY before WiFi.begin()
+        JOINING,    // waiting WL_CONNECTED or CONNECT_TIMEOUT
+        ONLINE,
+        WAITING     // failed, waiting RETRY_TIME
+    };
+
     DNSServer dnsServer; // DNS server instance for captive portal
 
+    State state = IDLE;
+    uint32_t stateTime = 0;
+    char ssid[33] = "";
+    char password[65] = "";
+    StatusCallback onStatus = nullptr;
+
+    void setState(State state)
+    {
+        this->state = state;
+        stateTime = millis();
+    }
+
+    void notify(Status status)
+    {
+        if (onStatus)
+            onStatus(status);
+    }
+
+    void beginStation()
+    {
+        Serial.printf("start wifi\n");
+        WiFi.begin(ssid, password);
+        setState(JOINING);
+        notify(CONNECTING);
+    }
+
 public:
 
     /*
@@ -54,33 +107,53 @@ public:
     }
 
     /*
-     * Connects to a WiFi network in station mode
+     * Sets the function called when the STA status changes
+     * @param callback - receives the new Status, called from update()
+     */
+    void setOnStatus(StatusCallback callback)
+    {
+        onStatus = callback;
+    }
+
+    /*
+     * Starts the connection to a WiFi network in station mode, returns at once
+     * A previous connection is closed first (reconnect with new credentials)
      * @param ssid - Network name
      * @param password - Network password
-     * Attempts connection for 20 seconds before timing out
+     * update() tries for 20 seconds, then again every RETRY_TIME
      */
     void connect(const char *ssid, const char *password)
     {
-        Serial.printf("start wifi\n");
+        strncpy(this->ssid, ssid, sizeof(this->ssid) - 1);
+        strncpy(this->password, password, sizeof(this->password) - 1);
 
-        WiFi.begin(ssid, password);
+        if (state == IDLE)
+            beginStation();
+        else
+        {
+            // the old connection needs some time to close
+            WiFi.disconnect(false);
+            setState(STARTING);
+        }
+    }
 
-        uint32_t current_time = millis();
-        // probamos conectarnos durante 20s
-        while (millis() - current_time < 20000)
+    /*
+     * Gets the status of the STA connection
+     */
+    Status getStatus()
+    {
+        switch (state)
         {
-            if (isConnected())
-            {
-                Serial.println("WiFi connected");
-                Serial.printf("IP Address: %s time: %dms\n",
-                              WiFi.localIP().toString(),
-                              millis() - current_time);
-                return;
-            }
-            delay(500);
+        case STARTING:
+        case JOINING:
+            return CONNECTING;
+        case ONLINE:
+            return CONNECTED;
+        case WAITING:
+            return FAILED;
+        default:
+            return DISCONNECTED;
         }
-        WiFi.disconnect(false);
-        Serial.printf("wifi: timeout!\n");
     }
 
     /*
@@ -98,15 +171,61 @@ public:
     void disconnect()
     {
         WiFi.disconnect(); // Desconecta de la red WiFi
+        if (state != IDLE)
+        {
+            setState(IDLE);
+            notify(DISCONNECTED);
+        }
     }
 
     /*
      * Processes DNS requests for captive portal functionality
+     * and the state of the STA connection
      * Should be called regularly in the main loop
      */
     void update()
     {
         dnsServer.processNextRequest(); // Procesa peticiones DNS (necesario para captive portal)
+
+        const uint32_t elapsed = millis() - stateTime;
+        switch (state)
+        {
+        case STARTING:
+            if (elapsed > RESTART_DELAY)
+                beginStation();
+            break;
+        case JOINING:
+            if (isConnected())
+            {
+                Serial.println("WiFi connected");
+                Serial.printf("IP Address: %s time: %dms\n",
+                              WiFi.localIP().toString().c_str(), elapsed);
+                setState(ONLINE);
+                notify(CONNECTED);
+            }
+            else if (elapsed > CONNECT_TIMEOUT)
+            {
+                WiFi.disconnect(false);
+                Serial.printf("wifi: timeout!\n");
+                setState(WAITING);
+                notify(FAILED);
+            }
+            break;
+        case ONLINE:
+            if (!isConnected())
+            {
+                Serial.printf("wifi: connection lost\n");
+                setState(STARTING);
+                notify(DISCONNECTED);
+            }
+            break;
+        case WAITING:
+            if (elapsed > RETRY_TIME)
+                beginStation();
+            break;
+        default:
+            break;
+        }
     }
 };
 
@@ -0,0 +1,114 @@
+/**
+ * @file SampleRing.h
+ * @brief Lock-free single-producer/single-consumer ring buffer.
+ */
+#ifndef SAMPLE_RING_H
+#define SAMPLE_RING_H
+
+#include <atomic>
+#include <stdint.h>
+
+/**
+ * @class SampleRing
+ * @brief Fixed-size SPSC queue used to hand samples from a task (or ISR) to loop().
+ *
+ * One side only calls push(), the other side only calls pop()/clear(), so no
+ * lock is needed: each index is written by a single owner and read by the other
+ * with acquire/release ordering. When the ring is full the new item is dropped
+ * and counted, the consumer can check getDropped() to detect overruns.
+ *
+ * @tparam T The type of the stored items (trivially copyable).
+ * @tparam N The capacity of the ring, must be a power of two.
+ */
+template <class T, uint32_t N>
+class SampleRing
+{
+    static_assert(N > 1 && (N & (N - 1)) == 0, "SampleRing size must be a power of two");
+
+public:
+    /**
+     * @brief Adds an item to the ring (producer side).
+     * @param item The item to copy into the ring.
+     * @return True if the item was stored, false if the ring was full.
+     */
+    bool push(const T &item)
+    {
+        const uint32_t h = head.load(std::memory_order_relaxed);
+        const uint32_t t = tail.load(std::memory_order_acquire);
+
+        if (h - t >= N)
+        {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        buffer[h & MASK] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Takes the oldest item from the ring (consumer side).
+     * @param item Receives the item.
+     * @return True if an item was available, false if the ring was empty.
+     */
+    bool pop(T &item)
+    {
+        const uint32_t t = tail.load(std::memory_order_relaxed);
+        const uint32_t h = head.load(std::memory_order_acquire);
+
+        if (h == t)
+            return false;
+
+        item = buffer[t & MASK];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Discards all pending items (consumer side).
+     */
+    void clear()
+    {
+        tail.store(head.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    /**
+     * @brief Gets the number of items waiting in the ring.
+     * @return The number of pending items.
+     */
+    uint32_t size() const
+    {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Checks if the ring has no pending items.
+     * @return True if empty, false otherwise.
+     */
+    bool isEmpty() const
+    {
+        return size() == 0;
+    }
+
+    /**
+     * @brief Gets the number of items lost because the ring was full.
+     * @return The drop counter since start.
+     */
+    uint32_t getDropped() const
+    {
+        return dropped.load(std::memory_order_relaxed);
+    }
+
+    const uint32_t maxSize = N;
+
+private:
+    static const uint32_t MASK = N - 1;
+
+    T buffer[N];
+    std::atomic<uint32_t> head{0};    ///< Next write position, owned by the producer.
+    std::atomic<uint32_t> tail{0};    ///< Next read position, owned by the consumer.
+    std::atomic<uint32_t> dropped{0}; ///< Items rejected because the ring was full.
+};
+
+#endif
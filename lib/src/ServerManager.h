@@ -184,17 +184,23 @@ public:
     void sendMessage(typeNotify type, const String &msg,
                      AsyncWebSocketClient *client = nullptr)
     {
-        JsonDocument doc;
+        String json = createJsonMessage(type, msg);
 
-        JsonObject o = doc["message"].to<JsonObject>();
+        send(json, client);
 
-        o["type"] = type;
-        o["content"] = msg;
+        Serial.println(json);
+    }
 
-        String json;
-        serializeJson(doc, json);
+    /**
+     * @brief Sends a notification message to all authenticated clients.
+     * @param type The type of notification.
+     * @param msg The notification message.
+     */
+    void sendMessageAuth(typeNotify type, const String &msg)
+    {
+        String json = createJsonMessage(type, msg);
 
-        send(json, client);
+        sendAllAuth(json);
 
         Serial.println(json);
     }
@@ -753,6 +759,26 @@ private:
 
     // end File
 
+    /**
+     * @brief Creates the JSON of a notification message.
+     * @param type The type of notification.
+     * @param msg The notification message.
+     * @return The JSON string of the message.
+     */
+    String createJsonMessage(typeNotify type, const String &msg)
+    {
+        JsonDocument doc;
+
+        JsonObject o = doc["message"].to<JsonObject>();
+
+        o["type"] = type;
+        o["content"] = msg;
+
+        String json;
+        serializeJson(doc, json);
+        return json;
+    }
+
     /**
      * @brief Creates a JSON string with system information.
      * @return The JSON string with system information.
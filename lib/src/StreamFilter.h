@@ -0,0 +1,196 @@
+/**
+ * @file StreamFilter.h
+ * @brief Streaming filters for integer samples (moving median, IIR, FIR).
+ */
+#ifndef STREAM_FILTER_H
+#define STREAM_FILTER_H
+
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * @class StreamFilter
+ * @brief One filter stage fed sample by sample, with a fixed memory footprint.
+ *
+ * Works on int32 samples (HX711 counts) with integer math only. Every type is
+ * set by a single size in samples:
+ *  - MEDIAN: moving median of the last size samples, removes spikes.
+ *  - IIR: single-pole low pass, alpha = 2 / (size + 1) like an EMA of size samples.
+ *  - FIR: triangular weighted average of the last size samples.
+ *
+ * The cost of a sample is bounded by MAX_SIZE, no heap is used. The first
+ * sample after reset() fills the state, so there is no ramp from zero.
+ */
+class StreamFilter
+{
+public:
+    enum Type : uint8_t
+    {
+        NONE = 0,
+        MEDIAN,
+        IIR,
+        FIR
+    };
+
+    static const uint8_t MAX_SIZE = 15;
+
+    /**
+     * @brief Selects the filter, the state is reset.
+     * @param type The filter type.
+     * @param size The window in samples (1 - MAX_SIZE), median and FIR use an odd size.
+     * @return False if the size is out of range, the filter is left as NONE.
+     */
+    bool begin(Type type, uint8_t size)
+    {
+        this->type = NONE;
+        this->size = 1;
+        reset();
+        if (type != NONE && (size < 1 || size > MAX_SIZE))
+            return false;
+
+        this->type = type;
+        this->size = (type == MEDIAN || type == FIR) ? (size | 1) : size;
+
+        // alpha in Q16
+        alpha = (2 << 16) / (this->size + 1);
+
+        // triangular weights 1 2 .. c .. 2 1
+        weightSum = 0;
+        const uint8_t center = this->size / 2;
+        for (uint8_t k = 0; k < this->size; k++)
+        {
+            weights[k] = center + 1 - (k > center ? k - center : center - k);
+            weightSum += weights[k];
+        }
+        return true;
+    }
+
+    /**
+     * @brief Clears the state, the next sample starts the filter again.
+     */
+    void reset()
+    {
+        count = 0;
+        head = 0;
+    }
+
+    /**
+     * @brief Filters one sample.
+     * @param value The new sample.
+     * @return The filtered value.
+     */
+    int32_t update(int32_t value)
+    {
+        switch (type)
+        {
+        case MEDIAN:
+            return median(value);
+        case IIR:
+            return iir(value);
+        case FIR:
+            return fir(value);
+        default:
+            return value;
+        }
+    }
+
+    Type getType() const { return type; }
+    uint8_t getSize() const { return size; }
+
+    /**
+     * @brief Gets a type by name, as sent by the web page.
+     * @param name "none", "median", "iir" or "fir".
+     * @param type Receives the type.
+     * @return False if the name is unknown.
+     */
+    static bool parseType(const char *name, Type &type)
+    {
+        static const char *names[] = {"none", "median", "iir", "fir"};
+        for (uint8_t i = 0; i < 4; i++)
+            if (name && strcmp(name, names[i]) == 0)
+            {
+                type = (Type)i;
+                return true;
+            }
+        return false;
+    }
+
+private:
+    Type type = NONE;
+    uint8_t size = 1;
+    uint8_t count = 0;
+    uint8_t head = 0;
+
+    int32_t history[MAX_SIZE]; ///< Last samples, ring from head.
+    int32_t sorted[MAX_SIZE];  ///< The same samples sorted, for the median.
+    int64_t state = 0;         ///< IIR output in Q16.
+    int32_t alpha = 0;         ///< IIR coefficient in Q16.
+    uint8_t weights[MAX_SIZE]; ///< FIR weights.
+    int32_t weightSum = 0;
+
+    // adds to the history ring, returns the sample that leaves it
+    int32_t pushHistory(int32_t value)
+    {
+        if (count == 0)
+        {
+            // primed with the first sample
+            for (uint8_t k = 0; k < size; k++)
+                history[k] = sorted[k] = value;
+            count = size;
+        }
+        int32_t old = history[head];
+        history[head] = value;
+        head = head + 1 == size ? 0 : head + 1;
+        return old;
+    }
+
+    int32_t median(int32_t value)
+    {
+        int32_t old = pushHistory(value);
+
+        // replace old by value in the sorted window, then shift it into place
+        uint8_t i = 0;
+        while (sorted[i] != old)
+            i++;
+        while (i > 0 && sorted[i - 1] > value)
+        {
+            sorted[i] = sorted[i - 1];
+            i--;
+        }
+        while (i + 1 < size && sorted[i + 1] < value)
+        {
+            sorted[i] = sorted[i + 1];
+            i++;
+        }
+        sorted[i] = value;
+        return sorted[size / 2];
+    }
+
+    int32_t iir(int32_t value)
+    {
+        const int64_t x = (int64_t)value << 16;
+        if (count == 0)
+        {
+            state = x;
+            count = 1;
+        }
+        state += ((x - state) * alpha) >> 16;
+        return (int32_t)((state + (1 << 15)) >> 16);
+    }
+
+    int32_t fir(int32_t value)
+    {
+        pushHistory(value);
+        // head is the oldest sample
+        int64_t acc = 0;
+        uint8_t j = head;
+        for (uint8_t k = 0; k < size; k++)
+        {
+            acc += (int64_t)history[j] * weights[k];
+            j = j + 1 == size ? 0 : j + 1;
+        }
+        return (int32_t)((acc + (acc < 0 ? -weightSum : weightSum) / 2) / weightSum);
+    }
+};
+
+#endif
@@ -6,6 +6,7 @@
 #include <list>
 #include <iterator>
 #include <vector>
+#include <algorithm>
 #include <ArduinoJson.h>
 
 
@@ -42,6 +43,7 @@ public:
 	virtual bool deserializeData(const String &json) = 0;
 	virtual String serializeString() = 0;
 	virtual void serializeData(JsonArray &obj, bool extra) = 0;
+	virtual ~Iserializable() {}
 };
 
 /**
@@ -55,20 +57,77 @@ class BaseData : public Iserializable
 protected:
 	T items[N];
 
+	static const uint SLOT_WORDS = (N + 31) / 32;
+	/**
+	 * @brief Bitmap of the free slots, bit i for items[i].
+	 * @details A slot is taken by push() and given back by remove(), pop(), shift() and clear(),
+	 *          so getEmpty() finds the lowest free item with a count trailing zeros.
+	 */
+	uint32_t freeSlots[SLOT_WORDS];
+
+	/**
+	 * @brief Marks the slot of an item as used, called by push().
+	 * @param item A pointer to the item, ignored if it is not from this pool.
+	 */
+	void takeSlot(T *item)
+	{
+		if (item >= items && item < items + N)
+		{
+			const uint i = item - items;
+			freeSlots[i / 32] &= ~(1UL << (i % 32));
+		}
+	}
+
+	/**
+	 * @brief Marks an item for reuse and its slot as free.
+	 * @param item A pointer to the item.
+	 */
+	void releaseSlot(T *item)
+	{
+		item->id = Item::CREATE_NEW;
+		if (item >= items && item < items + N)
+		{
+			const uint i = item - items;
+			freeSlots[i / 32] |= 1UL << (i % 32);
+		}
+	}
+
+	/**
+	 * @brief Marks all the slots as free.
+	 */
+	void resetSlots()
+	{
+		for (uint w = 0; w < SLOT_WORDS; w++)
+			freeSlots[w] = 0xFFFFFFFF;
+		if (N % 32)
+			freeSlots[SLOT_WORDS - 1] = (1UL << (N % 32)) - 1;
+	}
+
 public:
 	const int maxSize = N;
 
+	BaseData()
+	{
+		resetSlots();
+	}
+
 	/**
-	 * @brief Gets an empty item from the array.
+	 * @brief Gets an empty item from the array, O(1).
+	 * @details The same item is returned until it is pushed. It is the lowest free one, as the old scan.
 	 * @return A pointer to an empty item, or nullptr if no empty items are available.
 	 */
 	virtual T *getEmpty()
 	{
-		for (int i = 0; i < N; i++)
+		for (uint w = 0; w < SLOT_WORDS; w++)
 		{
-			T *item = &items[i];
-			if (item->id == Item::CREATE_NEW)
-				return item;
+			while (freeSlots[w])
+			{
+				T *item = &items[w * 32 + __builtin_ctz(freeSlots[w])];
+				if (item->id == Item::CREATE_NEW)
+					return item;
+				// its id was set but it was not pushed (failed deserializeItem), as the old scan skip it
+				freeSlots[w] &= freeSlots[w] - 1;
+			}
 		}
 		return nullptr;
 	};
@@ -97,6 +156,7 @@ public:
 			T *item = &items[i];
 			item->id = Item::CREATE_NEW;
 		}
+		resetSlots();
 	}
 
 	// Iserializable
@@ -193,10 +253,14 @@ public:
 
 	/**
 	 * @brief Accesses an item in the map using the key.
-	 * @param key The key of the item to access.
+	 * @param key The key of the item to access, a missing key is not added.
 	 * @return A pointer to the item, or nullptr if the key is not found.
 	 */
-	T *operator[](K key) { return mapItems[key]; };
+	T *operator[](K key)
+	{
+		auto it = mapItems.find(key);
+		return it != mapItems.end() ? it->second : nullptr;
+	};
 	/**
 	 * @brief Gets the number of items in the map.
 	 * @return The number of items in the map.
@@ -233,7 +297,7 @@ public:
 			if (this->mapItems.erase(key))
 			{
 				// lo marcamos para reutilizacion
-				item->id = Item::CREATE_NEW;
+				this->releaseSlot(item);
 				return true;
 			}
 		}
@@ -290,8 +354,31 @@ template <uint N, class T>
 class DataTable : public MapBaseData<N, T, uint32_t>
 {
 protected:
+	static const uint ID_WORDS = (N + 31) / 32;
+	/**
+	 * @brief Bitmap of the ids in use, bit i for id i.
+	 * @details Only the ids 0..N-1 that getUniqueId() can give, explicit ids from N on are only in the map.
+	 */
+	uint32_t usedIds[ID_WORDS] = {};
+
+	/**
+	 * @brief Marks an id as used or free in the bitmap.
+	 * @param id The id, ignored if it is not lower than N.
+	 * @param used True if the id is in use.
+	 */
+	void setIdUsed(uint32_t id, bool used)
+	{
+		if (id >= N)
+			return;
+		if (used)
+			usedIds[id / 32] |= 1UL << (id % 32);
+		else
+			usedIds[id / 32] &= ~(1UL << (id % 32));
+	}
+
 	/**
 	 * @brief Gets a unique ID for a new item.
+	 * @details The lowest free id, a count trailing zeros per word of the bitmap: O(N/32).
 	 * @param id The preferred ID for the item. If Item::CREATE_NEW, a new unique ID is generated.
 	 * @return A unique ID for the item.
 	 */
@@ -299,10 +386,14 @@ protected:
 	{
 		if (id < Item::CREATE_NEW)
 			return id;
-		for (int i = 0; i < N; i++)
+		for (uint w = 0; w < ID_WORDS; w++)
 		{
-			if (this->mapItems.find(i) == this->mapItems.end())
-				return i;
+			const uint32_t free = ~usedIds[w];
+			if (free)
+			{
+				const uint i = w * 32 + __builtin_ctz(free);
+				return i < N ? i : Item::CREATE_NEW;
+			}
 		}
 		return Item::CREATE_NEW;
 	};
@@ -321,12 +412,37 @@ public:
 			if (id < Item::CREATE_NEW)
 			{
 				item->id = id;
+				this->takeSlot(item);
 				this->mapItems.insert(std::make_pair(id, item));
+				setIdUsed(id, true);
 				return item;
 			}
 		}
 		return nullptr;
 	};
+
+	/**
+	 * @brief Removes an item from the table by its id, the id can be given again.
+	 * @param key The id of the item to remove.
+	 * @return True if the item was successfully removed, false otherwise.
+	 */
+	bool remove(uint32_t key)
+	{
+		if (!MapBaseData<N, T, uint32_t>::remove(key))
+			return false;
+		setIdUsed(key, false);
+		return true;
+	};
+
+	/**
+	 * @brief Clears all items in the table and frees all the ids.
+	 */
+	void clear()
+	{
+		MapBaseData<N, T, uint32_t>::clear();
+		for (uint w = 0; w < ID_WORDS; w++)
+			usedIds[w] = 0;
+	};
 };
 
 /**
@@ -373,6 +489,7 @@ public:
 		if (item)
 		{
 			item->id = 1;
+			this->takeSlot(item);
 			listItems.push_back(item);
 			return item;
 		}
@@ -389,6 +506,7 @@ public:
 		if (item)
 		{
 			item->id = 1;
+			this->takeSlot(item);
 			listItems.push_front(item);
 			return item;
 		}
@@ -421,7 +539,7 @@ public:
 			listItems.erase(it);
 
 			// lo marcamos para reutilizacion
-			item->id = Item::CREATE_NEW;
+			this->releaseSlot(item);
 
 			return true;
 		}
@@ -448,7 +566,7 @@ public:
 			return false;
 
 		// lo marcamos para reutilizacion
-		listItems.front()->id = Item::CREATE_NEW;
+		this->releaseSlot(listItems.front());
 		listItems.pop_front();
 		return true;
 	};
@@ -461,7 +579,7 @@ public:
 		if (size() <= 0)
 			return false;
 		// lo marcamos para reutilizacion
-		listItems.back()->id = Item::CREATE_NEW;
+		this->releaseSlot(listItems.back());
 		listItems.pop_back();
 		return true;
 	};
@@ -558,6 +676,7 @@ public:
 		if (item)
 		{
 			item->id = 1;
+			this->takeSlot(item);
 			arrayItems.push_back(item);
 			return item;
 		}
@@ -590,7 +709,7 @@ public:
 			arrayItems.erase(it);
 
 			// lo marcamos para reutilizacion
-			item->id = Item::CREATE_NEW;
+			this->releaseSlot(item);
 
 			return true;
 		}
@@ -606,6 +725,16 @@ public:
 		arrayItems.clear();
 	}
 
+	/**
+	 * @brief Sorts the items of the array, the storage of the items doesn't move.
+	 * @param compare A function that returns true if the first item goes before the second.
+	 */
+	template <class Compare>
+	void sort(Compare compare)
+	{
+		std::sort(arrayItems.begin(), arrayItems.end(), compare);
+	}
+
 	/**
 	 * @brief Removes the last item from the array.
 	 * @return True if an item was successfully removed, false otherwise.
@@ -615,7 +744,7 @@ public:
 		if (size() <= 0)
 			return false;
 		// lo marcamos para reutilizacion
-		arrayItems.back()->id = Item::CREATE_NEW;
+		this->releaseSlot(arrayItems.back());
 		arrayItems.pop_back();
 		return true;
 	}
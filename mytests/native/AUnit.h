@@ -0,0 +1,77 @@
+#ifndef NATIVE_AUNIT_H
+#define NATIVE_AUNIT_H
+
+#include "Arduino.h"
+#include <vector>
+
+/*
+ * The test() and assert macros of AUnit used by mytests, so the same
+ * sketches run on the PC. TestRunner::run() runs every test once and exits
+ * with the number of failures.
+ */
+
+namespace aunit
+{
+	struct Test
+	{
+		const char *name;
+		void (*body)(bool &passed);
+	};
+
+	inline std::vector<Test> &tests()
+	{
+		static std::vector<Test> list;
+		return list;
+	}
+
+	struct TestAdder
+	{
+		TestAdder(const char *name, void (*body)(bool &)) { tests().push_back({name, body}); }
+	};
+
+	class TestRunner
+	{
+	public:
+		static void run()
+		{
+			int failed = 0;
+			for (const Test &test : tests())
+			{
+				bool passed = true;
+				test.body(passed);
+				printf("Test %s %s\n", test.name, passed ? "passed" : "failed");
+				failed += !passed;
+			}
+			printf("TestRunner summary: %d failed of %d\n", failed, (int)tests().size());
+			exit(failed);
+		}
+	};
+}
+
+#define test(name)                                                \
+	static void name##_body(bool &aunit_passed);                  \
+	static aunit::TestAdder name##_adder(#name, name##_body);     \
+	static void name##_body(bool &aunit_passed)
+
+#define aunitCheck(condition, text)                                              \
+	do                                                                           \
+	{                                                                            \
+		if (!(condition))                                                        \
+		{                                                                        \
+			printf("Assertion failed: %s, file %s, line %d\n", text, __FILE__, __LINE__); \
+			aunit_passed = false;                                                \
+			return;                                                              \
+		}                                                                        \
+	} while (0)
+
+#define assertTrue(a) aunitCheck((a), #a " is true")
+#define assertFalse(a) aunitCheck(!(a), #a " is false")
+#define assertEqual(a, b) aunitCheck((a) == (b), #a " == " #b)
+#define assertNotEqual(a, b) aunitCheck((a) != (b), #a " != " #b)
+#define assertLess(a, b) aunitCheck((a) < (b), #a " < " #b)
+#define assertMore(a, b) aunitCheck((a) > (b), #a " > " #b)
+#define assertLessOrEqual(a, b) aunitCheck((a) <= (b), #a " <= " #b)
+#define assertMoreOrEqual(a, b) aunitCheck((a) >= (b), #a " >= " #b)
+#define assertNear(a, b, error) aunitCheck(fabs((double)(a) - (double)(b)) <= (error), #a " ~ " #b)
+
+#endif
@@ -0,0 +1,121 @@
+#ifndef NATIVE_ARDUINO_H
+#define NATIVE_ARDUINO_H
+
+/*
+ * The few parts of the ESP32 Arduino core that the headers of src use,
+ * for the [env:native] builds on a PC (benches and replay, see
+ * platformio.ini). Not a board: no pins, no tasks, time from the host clock.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+#include <string>
+#include <algorithm>
+
+typedef unsigned int uint;
+
+#include "pgmspace.h"
+
+// WString.h, only what src and ArduinoJson use
+class String
+{
+public:
+	String(const char *str = "") : s(str ? str : "") {}
+	String(const std::string &str) : s(str) {}
+	String(char c) : s(1, c) {}
+	String(int value) : s(std::to_string(value)) {}
+	String(unsigned int value) : s(std::to_string(value)) {}
+	String(long value) : s(std::to_string(value)) {}
+	String(unsigned long value) : s(std::to_string(value)) {}
+	String(float value, unsigned char decimals = 2) { setFloat(value, decimals); }
+	String(double value, unsigned char decimals = 2) { setFloat(value, decimals); }
+
+	String &operator=(const char *str)
+	{
+		s = str ? str : "";
+		return *this;
+	}
+	bool concat(const char *str)
+	{
+		s += str ? str : "";
+		return true;
+	}
+	bool concat(const char *str, size_t length)
+	{
+		s.append(str, length);
+		return true;
+	}
+	String &operator+=(const String &str)
+	{
+		s += str.s;
+		return *this;
+	}
+
+	const char *c_str() const { return s.c_str(); }
+	size_t length() const { return s.size(); }
+	bool operator==(const String &str) const { return s == str.s; }
+	bool operator!=(const String &str) const { return s != str.s; }
+	int indexOf(char c) const
+	{
+		size_t pos = s.find(c);
+		return pos == std::string::npos ? -1 : (int)pos;
+	}
+	String substring(size_t from) const { return String(s.substr(std::min(from, s.size()))); }
+	String substring(size_t from, size_t to) const { return String(s.substr(std::min(from, s.size()), to - from)); }
+	int toInt() const { return atoi(s.c_str()); }
+	float toFloat() const { return atof(s.c_str()); }
+
+private:
+	std::string s;
+
+	void setFloat(double value, unsigned char decimals)
+	{
+		char buffer[32];
+		snprintf(buffer, sizeof(buffer), "%.*f", decimals, value);
+		s = buffer;
+	}
+};
+class StringSumHelper : public String
+{
+public:
+	using String::String;
+};
+inline String operator+(const String &a, const String &b)
+{
+	String sum(a);
+	sum += b;
+	return sum;
+}
+
+// Serial on the console
+class HardwareSerial
+{
+public:
+	void begin(unsigned long baud) {}
+	__attribute__((format(printf, 2, 3))) size_t printf(const char *format, ...)
+	{
+		va_list args;
+		va_start(args, format);
+		int n = vprintf(format, args);
+		va_end(args);
+		return n;
+	}
+	size_t print(const char *str) { return ::printf("%s", str); }
+	size_t print(const String &str) { return print(str.c_str()); }
+	size_t println(const char *str = "") { return ::printf("%s\n", str); }
+	size_t println(const String &str) { return println(str.c_str()); }
+};
+extern HardwareSerial Serial;
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void yield();
+int64_t esp_timer_get_time();
+
+#endif
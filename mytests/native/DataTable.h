@@ -0,0 +1,2 @@
+// data.h includes it as DataTable.h, lib/src has dataTable.h
+#include "dataTable.h"
@@ -0,0 +1,102 @@
+#ifndef NATIVE_LITTLEFS_H
+#define NATIVE_LITTLEFS_H
+
+#include "Arduino.h"
+#include <sys/stat.h>
+
+/*
+ * LittleFS on a folder of the PC, root + path. The parents of a file
+ * opened for writing are created, /data is there on the board.
+ */
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+enum SeekMode
+{
+	SeekSet = SEEK_SET,
+	SeekCur = SEEK_CUR,
+	SeekEnd = SEEK_END
+};
+
+class File
+{
+public:
+	File(FILE *file = nullptr) : file(file) {}
+
+	operator bool() const { return file != nullptr; }
+
+	size_t write(const uint8_t *buffer, size_t size) { return file ? fwrite(buffer, 1, size, file) : 0; }
+	size_t write(uint8_t c) { return write(&c, 1); }
+	size_t read(uint8_t *buffer, size_t size) { return file ? fread(buffer, 1, size, file) : 0; }
+	int read() { return file ? fgetc(file) : -1; }
+	size_t readBytes(char *buffer, size_t size) { return read((uint8_t *)buffer, size); }
+	bool seek(uint32_t pos, SeekMode mode = SeekSet) { return file && fseek(file, pos, mode) == 0; }
+	size_t position() const { return file ? ftell(file) : 0; }
+	size_t size() const
+	{
+		struct stat st;
+		return file && fstat(fileno(file), &st) == 0 ? st.st_size : 0;
+	}
+	void flush()
+	{
+		if (file)
+			fflush(file);
+	}
+	void close()
+	{
+		if (file)
+			fclose(file);
+		file = nullptr;
+	}
+
+private:
+	FILE *file;
+};
+
+class LittleFSFS
+{
+public:
+	// folder of the file system, LITTLEFS_ROOT or the working directory
+	std::string root;
+
+	LittleFSFS()
+	{
+		const char *env = getenv("LITTLEFS_ROOT");
+		root = env ? env : ".";
+	}
+
+	bool begin(bool format_if_failed = false) { return true; }
+
+	File open(const char *path, const char *mode = FILE_READ, bool create = false)
+	{
+		const std::string full = root + path;
+		if (mode[0] != 'r')
+			makeParents(full);
+		return File(fopen(full.c_str(), (std::string(mode) + "b").c_str()));
+	}
+	File open(const String &path, const char *mode = FILE_READ, bool create = false) { return open(path.c_str(), mode, create); }
+
+	bool exists(const char *path)
+	{
+		struct stat st;
+		return stat((root + path).c_str(), &st) == 0;
+	}
+	bool exists(const String &path) { return exists(path.c_str()); }
+	bool remove(const char *path) { return ::remove((root + path).c_str()) == 0; }
+	bool remove(const String &path) { return remove(path.c_str()); }
+	bool rename(const char *from, const char *to) { return ::rename((root + from).c_str(), (root + to).c_str()) == 0; }
+	bool rename(const String &from, const String &to) { return rename(from.c_str(), to.c_str()); }
+
+private:
+	static void makeParents(const std::string &path)
+	{
+		for (size_t pos = path.find('/', 1); pos != std::string::npos; pos = path.find('/', pos + 1))
+			::mkdir(path.substr(0, pos).c_str(), 0755);
+	}
+};
+
+extern LittleFSFS LittleFS;
+
+#endif
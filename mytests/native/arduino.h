@@ -0,0 +1,2 @@
+// data.h includes it in lower case, the file system of the PC is not case insensitive
+#include "Arduino.h"
@@ -0,0 +1,2 @@
+// as in the ESP32 core
+#include "../pgmspace.h"
@@ -0,0 +1,31 @@
+#include "Arduino.h"
+#include "LittleFS.h"
+#include <chrono>
+#include <thread>
+
+// the globals and the clock of the ESP32 core, on the PC
+
+HardwareSerial Serial;
+LittleFSFS LittleFS;
+
+static const std::chrono::steady_clock::time_point boot = std::chrono::steady_clock::now();
+
+int64_t esp_timer_get_time()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - boot).count();
+}
+uint32_t millis()
+{
+	return esp_timer_get_time() / 1000;
+}
+uint32_t micros()
+{
+	return esp_timer_get_time();
+}
+void delay(uint32_t ms)
+{
+	std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+void yield()
+{
+}
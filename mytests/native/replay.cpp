@@ -0,0 +1,118 @@
+#include "TestAnalyzer.h"
+#include <vector>
+
+/*
+ * Replay of a test captured by the ESP32 (src/SampleLog.h) with the code of
+ * the firmware: SampleLogReader reads it, every sample goes through
+ * TestAnalyzer as while the test ran and resample() gives the bins the
+ * result would get on a new grid. See [env:replay] in platformio.ini.
+ *
+ * Download /data/result/<name>.bin (the last run of a result) or
+ * /data/last_test.bin (a test not saved) from the system page and run:
+ *   replay <name>.bin                          bins of the run + properties
+ *   replay <name>.bin --factor -52236.7        recalibrated (counts/kg)
+ *   replay <name>.bin --length 50 --area 4     with the specimen (mm, mm2)
+ *   replay <name>.bin --fit 1 3                band of the modulus fit (kg)
+ *   replay <name>.bin --band 400 200           band of a new grid (ms)
+ *   replay <name>.bin --csv out                the bins to out.csv
+ */
+
+struct Sample
+{
+	int64_t time;
+	float distance;
+	int32_t force;
+};
+
+static const char *option(int argc, char **argv, const char *name, int index = 1)
+{
+	for (int i = 1; i + index < argc; i++)
+		if (!strcmp(argv[i], name))
+			return argv[i + index];
+	return nullptr;
+}
+
+int main(int argc, char **argv)
+{
+	if (argc < 2)
+	{
+		printf("usage: replay <log.bin> [--factor f] [--length mm --area mm2] [--fit low high] [--band before after] [--csv name]\n");
+		return 1;
+	}
+	// the paths of the PC as they are
+	LittleFS.root = "";
+	const String path = argv[1];
+
+	// the samples of the log, the copy the analyzer writes can't overwrite them
+	static SampleBlock block;
+	SampleLogReader reader;
+	if (!reader.open(path.c_str()))
+		return 1;
+	const SampleLogHeader header = reader.getHeader();
+	std::vector<Sample> samples;
+	for (uint32_t b = 0; b < reader.getBlocks() && reader.readBlock(b, block); b++)
+		for (uint32_t i = 0; i < block.count; i++)
+			samples.push_back({block.timeAt(i), block.samples[i].distance, block.samples[i].force});
+	reader.close();
+	if (samples.size() < 2)
+	{
+		printf("not enough samples\n");
+		return 1;
+	}
+
+	Calibration calibration;
+	calibration.set(header.offset, option(argc, argv, "--factor") ? atof(option(argc, argv, "--factor")) : header.factor);
+	const float length = option(argc, argv, "--length") ? atof(option(argc, argv, "--length")) : 0;
+	const float area = option(argc, argv, "--area") ? atof(option(argc, argv, "--area")) : 0;
+	printf("%u samples at %uhz, %.1fs, factor %.1f\n", (unsigned)samples.size(), header.sampleRate,
+		   (samples.back().time - samples.front().time) / 1e6, header.factor);
+
+	static TestAnalyzer analyzer;
+	analyzer.clear();
+	analyzer.clearData();
+	analyzer.setCalibration(calibration);
+	// the modulus fit between 10% and 30% of the default max force, as beginTest()
+	analyzer.setSpecimen(length, option(argc, argv, "--fit", 2) ? atof(option(argc, argv, "--fit", 1)) : 1.0f,
+						 option(argc, argv, "--fit", 2) ? atof(option(argc, argv, "--fit", 2)) : 3.0f);
+	if (option(argc, argv, "--band", 2))
+		analyzer.setBand(atoi(option(argc, argv, "--band", 1)), atoi(option(argc, argv, "--band", 2)));
+	const String copy = path + ".replay";
+	analyzer.setStream(copy.c_str());
+	analyzer.trigger(0, header.zeroTime);
+	for (const Sample &sample : samples)
+		analyzer.addRaw(sample.distance, sample.force, sample.time);
+	analyzer.endStream();
+
+	float distance[TestAnalyzer::MAX_RESULT], force[TestAnalyzer::MAX_RESULT];
+	analyzer.resample(distance, force);
+	const TestAnalyzer::Grid &grid = analyzer.getGrid();
+
+	FILE *csv = nullptr;
+	if (option(argc, argv, "--csv"))
+	{
+		const String name = String(option(argc, argv, "--csv")) + ".csv";
+		csv = fopen(name.c_str(), "w");
+		if (csv)
+			fprintf(csv, "bin,time_ms,distance,force\n");
+	}
+	printf(" bin |      t |      d |      f\n");
+	for (uint8_t bin = 0; bin < TestAnalyzer::MAX_RESULT; bin++)
+	{
+		printf("%4u | %6d | %6.3f | %6.2f%s\n", bin, (int)grid[bin], distance[bin], force[bin],
+			   bin == TestAnalyzer::PEAK_BIN ? "  peak" : "");
+		if (csv)
+			fprintf(csv, "%u,%d,%.4f,%.3f\n", bin, (int)grid[bin], distance[bin], force[bin]);
+	}
+	if (csv)
+		fclose(csv);
+
+	const TestProperties properties = analyzer.getProperties(length, area);
+	printf("peak %.2fN %.3fmm, stiffness %.1fN/mm, yield %.2fN, elongation %.3fmm, energy %.4fJ\n",
+		   properties.peakForce, properties.peakDistance, properties.stiffness,
+		   properties.yieldForce, properties.elongation, properties.energy);
+	if (area > 0)
+		printf("peak %.2fMPa, modulus %.1fMPa, yield %.2fMPa, strain %.2f%%\n",
+			   properties.peakStress, properties.modulus, properties.yieldStress, properties.strain);
+	LittleFS.remove(copy);
+	return 0;
+}
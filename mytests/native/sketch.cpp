@@ -0,0 +1,12 @@
+// runs a mytests sketch like the Arduino core, setup() and then loop()
+// until TestRunner::run() exits
+
+void setup();
+void loop();
+
+int main()
+{
+	setup();
+	for (;;)
+		loop();
+}
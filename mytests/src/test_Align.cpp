@@ -0,0 +1,180 @@
+#include <AUnit.h>
+#include "TestAnalyzer.h"
+
+TestAnalyzer analyzer;
+
+const int64_t PERIOD = 12500; // 80hz
+const int64_t BREAK = 3000000; // us, true break of every run
+
+uint32_t seed = 1;
+float noise()
+{
+    seed = seed * 1664525 + 1013904223;
+    return (seed >> 8) / float(1 << 24) - 0.5;
+}
+
+// concave up to 20kg at the break, then 1kg. bump: a false peak before
+// the break (kg over the curve, at BREAK - 40ms). Returns the time of the
+// max sample, what ALIGN_PEAK uses. until_ready: the samples stop when the
+// window is ready, as the test ends after a break
+int64_t feed(int64_t phase, float amplitude, float bump = 0, bool until_ready = false)
+{
+    analyzer.clearData();
+    float max = -1;
+    int64_t max_time = 0;
+    for (int64_t t = phase; t < BREAK + 400000; t += PERIOD)
+    {
+        float x = (BREAK - t) / 400000.0f;
+        float f = t < BREAK ? 20 * (1 - x * x) : 1.0f;
+        if (bump > 0 && t >= BREAK - 50000 && t < BREAK - 30000)
+            f += bump;
+        f += noise() * amplitude;
+        if (f > max)
+        {
+            max = f;
+            max_time = t;
+        }
+        analyzer.addSample(t / 1e6f, f, t);
+        if (until_ready && analyzer.isAlignReady())
+            break;
+    }
+    return max_time;
+}
+
+// result of 5 clean runs aligned on their peak
+void makeResult()
+{
+    analyzer.clear();
+    analyzer.setAlign(TestAnalyzer::ALIGN_PEAK);
+    for (int k = 0; k < 5; k++)
+    {
+        feed(k * 2500, 0.05);
+        analyzer.addTest(k);
+    }
+}
+
+test(AlignDoublePeak)
+{
+    makeResult();
+    float distance[TestAnalyzer::MAX_RESULT], force[TestAnalyzer::MAX_RESULT];
+
+    // the false peak is 40ms before the break
+    analyzer.setAlign(TestAnalyzer::ALIGN_PEAK);
+    int64_t peak = feed(1000, 0.05, 3);
+    analyzer.resample(distance, force);
+    assertNear((BREAK - peak) / 1000.0, 40.0, 12.5);
+    assertEqual(analyzer.getAlignShift(), 0.0f);
+
+    // the correlation moves it back to the break
+    analyzer.setAlign(TestAnalyzer::ALIGN_XCORR);
+    analyzer.resample(distance, force);
+    float error = (peak + analyzer.getAlignShift() * 1000 - BREAK) / 1000.0;
+    assertNear(error, 0.0, 12.5);
+    // the peak bin of the run is the peak of the curve
+    assertNear(force[TestAnalyzer::PEAK_BIN], 20.0, 1.0);
+}
+
+test(AlignPositiveShift)
+{
+    makeResult();
+    float distance[TestAnalyzer::MAX_RESULT], force[TestAnalyzer::MAX_RESULT];
+
+    // the test ends with the window, the true break 40ms after the max sample
+    analyzer.setAlign(TestAnalyzer::ALIGN_XCORR);
+    int64_t peak = feed(1000, 0.05, 3, true);
+    assertTrue(analyzer.isWindowReady());
+    assertTrue(analyzer.isAlignReady());
+    analyzer.resample(distance, force);
+    // forward, as far as the result (aligned on its max samples) allows
+    assertMore(analyzer.getAlignShift(), 20.0f);
+    assertNear((peak + analyzer.getAlignShift() * 1000 - BREAK) / 1000.0, 0.0, 12.5);
+    analyzer.setAlign(TestAnalyzer::ALIGN_PEAK);
+}
+
+test(AlignWindowCut)
+{
+    makeResult();
+    float distance[TestAnalyzer::MAX_RESULT], force[TestAnalyzer::MAX_RESULT];
+
+    // cut at the end of the band, no room after it: only the peak,
+    // not a shift to the side that has samples
+    analyzer.setAlign(TestAnalyzer::ALIGN_XCORR);
+    analyzer.clearData();
+    for (int64_t t = 1000; !analyzer.isWindowReady(); t += PERIOD)
+    {
+        float x = (BREAK - t) / 400000.0f;
+        analyzer.addSample(t / 1e6f, t < BREAK ? 20 * (1 - x * x) : 1.0f, t);
+    }
+    assertFalse(analyzer.isAlignReady());
+    analyzer.resample(distance, force);
+    assertLess(fabsf(analyzer.getAlignShift()), (float)TestAnalyzer::ALIGN_LAG_STEP);
+    analyzer.setAlign(TestAnalyzer::ALIGN_PEAK);
+}
+
+test(AlignNoise)
+{
+    makeResult();
+    float distance[TestAnalyzer::MAX_RESULT], force[TestAnalyzer::MAX_RESULT];
+    float error_peak = 0, error_xcorr = 0;
+    const int RUNS = 20;
+
+    // noisy runs, the max sample jumps between the last samples
+    for (int k = 0; k < RUNS; k++)
+    {
+        analyzer.setAlign(TestAnalyzer::ALIGN_XCORR);
+        int64_t peak = feed(k * 1300, 1.5);
+        analyzer.resample(distance, force);
+        error_peak += fabs((peak - BREAK) / 1000.0);
+        error_xcorr += fabs((peak + analyzer.getAlignShift() * 1000 - BREAK) / 1000.0);
+    }
+    Serial.printf("mean error peak %.1f ms, xcorr %.1f ms\n", error_peak / RUNS, error_xcorr / RUNS);
+    assertLess(error_xcorr, error_peak);
+    assertLess(error_xcorr / RUNS, 12.5f);
+}
+
+test(AlignNoResult)
+{
+    // without a result there is nothing to correlate, the peak is used
+    analyzer.clear();
+    analyzer.setAlign(TestAnalyzer::ALIGN_XCORR);
+    feed(0, 0.05, 3);
+    analyzer.addTest(0);
+    assertEqual(analyzer.getAlignShift(), 0.0f);
+    analyzer.setAlign(TestAnalyzer::ALIGN_PEAK);
+}
+
+// on the board with env:mytests, on the PC with env:native and this file
+// in its build_src_filter (platformio.ini)
+test(AlignBench)
+{
+    makeResult();
+    float distance[TestAnalyzer::MAX_RESULT], force[TestAnalyzer::MAX_RESULT];
+    feed(1000, 0.5);
+    const int LOOPS = 100;
+
+    analyzer.setAlign(TestAnalyzer::ALIGN_PEAK);
+    uint32_t c = micros();
+    for (int i = 0; i < LOOPS; i++)
+        analyzer.resample(distance, force);
+    uint32_t tPeak = micros() - c;
+
+    analyzer.setAlign(TestAnalyzer::ALIGN_XCORR);
+    c = micros();
+    for (int i = 0; i < LOOPS; i++)
+        analyzer.resample(distance, force);
+    uint32_t tXcorr = micros() - c;
+
+    Serial.printf("resample peak %.1f us, xcorr %.1f us\n", tPeak / float(LOOPS), tXcorr / float(LOOPS));
+    analyzer.setAlign(TestAnalyzer::ALIGN_PEAK);
+}
+
+void setup()
+{
+    delay(1000);
+    Serial.begin(115200);
+}
+
+void loop()
+{
+    aunit::TestRunner::run();
+}
@@ -0,0 +1,102 @@
+#include <AUnit.h>
+#include "BreakDetector.h"
+
+// simulated specimen at 80hz, 10000 counts/kg
+const int64_t PERIOD = 12500;
+const int64_t BREAK_TIME = 6003000; // us, between two conversions
+const int32_t KG = 10000;
+
+// linear up to 20kg at the break, then the force falls in 2 conversions
+int32_t specimen(int64_t t, uint32_t &seed)
+{
+    seed = seed * 1664525 + 1013904223;
+    int32_t noise = int32_t(seed >> 24) - 128; // +-13g
+    if (t < BREAK_TIME)
+        return t * 20 * KG / BREAK_TIME + noise;
+    if (t < BREAK_TIME + 2 * PERIOD)
+        return 8 * KG + noise;
+    return KG / 10 + noise;
+}
+
+test(BreakDetectorNoise)
+{
+    BreakDetector detector;
+    detector.arm(30, 100, KG);
+    uint32_t seed = 1;
+    // noise and a slow decline of a yield do not trip it
+    for (int64_t t = 0; t < 20000000; t += PERIOD)
+    {
+        int32_t f = t < BREAK_TIME ? specimen(t, seed) : 20 * KG - (t - BREAK_TIME) * KG / 1000000;
+        assertFalse(detector.update(f, t));
+    }
+    // not armed
+    BreakDetector off;
+    assertFalse(off.update(0, 0));
+}
+
+test(BreakDetectorLatency)
+{
+    BreakDetector detector;
+    detector.arm(30, 100, KG);
+    uint32_t seed = 1;
+
+    // per sample, in the sampler task
+    int64_t tripAt = -1;
+    uint32_t samples = 0;
+    uint32_t c = micros();
+    for (int64_t t = 0; t < BREAK_TIME + 1000000 && tripAt < 0; t += PERIOD, samples++)
+        if (detector.update(specimen(t, seed), t))
+            tripAt = t;
+    c = micros() - c;
+    assertTrue(detector.hasTripped());
+    assertFalse(detector.isArmed());
+    assertNear(detector.getTripForce(), 20 * KG, KG / 10);
+
+    // the old updateTest(): loop() every 20ms, force < 0.5kg and one more tick
+    int64_t oldStop = -1;
+    uint8_t count = 0;
+    bool ready = false;
+    seed = 1;
+    int32_t last = 0;
+    int64_t nextSample = 0;
+    for (int64_t t = 0; oldStop < 0; t += 20000)
+    {
+        while (nextSample <= t)
+        {
+            last = specimen(nextSample, seed);
+            nextSample += PERIOD;
+        }
+        if (last > KG)
+            ready = true;
+        if (ready && last < KG / 2)
+        {
+            if (count < 1)
+                count++;
+            else
+                oldStop = t;
+        }
+    }
+
+    Serial.printf("break to stop: per sample detector %.1fms, old loop check %.1fms\n",
+                  (tripAt - BREAK_TIME) / 1000.0, (oldStop - BREAK_TIME) / 1000.0);
+    Serial.printf("detector cost %.3fus per sample\n", c / float(samples));
+    // the first sample after the break
+    assertLess(tripAt - BREAK_TIME, PERIOD);
+    assertLess(tripAt, oldStop);
+
+    // armed again for the next test
+    detector.arm(30, 100, KG);
+    assertFalse(detector.hasTripped());
+    assertFalse(detector.update(0, 0));
+}
+
+void setup()
+{
+    delay(1000);
+    Serial.begin(115200);
+}
+
+void loop()
+{
+    aunit::TestRunner::run();
+}
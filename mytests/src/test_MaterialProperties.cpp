@@ -0,0 +1,84 @@
+#include <AUnit.h>
+#include "MaterialProperties.h"
+
+// 10000 counts/kg, specimen 50mm x 10mm2
+Calibration calibration;
+const float LENGTH = 50;
+const float AREA = 10;
+
+// toe until 0.2mm, 2kg/mm until 10kg, hardening 0.1kg/mm, break at 10.2mm
+float curve(float x)
+{
+    if (x < 0.2f)
+        return 0;
+    if (x < 5.2f)
+        return 2.0f * (x - 0.2f);
+    if (x <= 10.2f)
+        return 10.0f + 0.1f * (x - 5.2f);
+    return 0;
+}
+
+void run(PropertyTracker &tracker)
+{
+    tracker.begin(calibration.fromKg(1.0), calibration.fromKg(4.0), LENGTH * 1000 * 0.002f);
+    // 5um per sample, a few after the break
+    for (int i = 0; i <= 2100; i++)
+    {
+        int32_t x = i * 5;
+        tracker.add(x, calibration.fromKg(curve(x / 1000.0f)));
+    }
+}
+
+test(PropertiesBilinear)
+{
+    PropertyTracker tracker;
+    run(tracker);
+    assertTrue(tracker.hasFit());
+    assertTrue(tracker.hasYield());
+
+    TestProperties p = tracker.get(calibration, LENGTH, AREA);
+    assertNear(p.stiffness, 2.0f * GRAVITY, 0.01);
+    assertNear(p.modulus, 2.0f * GRAVITY * LENGTH / AREA, 0.1);
+    // 0.2% offset line: 2(x - 0.3) crosses 10 + 0.1(x - 5.2)
+    assertNear(p.yieldDistance, 10.08f / 1.9f, 0.002);
+    assertNear(p.yieldForce, (10.0f + 0.1f * (10.08f / 1.9f - 5.2f)) * GRAVITY, 0.02);
+    assertNear(p.yieldStress, p.yieldForce / AREA, 0.001);
+
+    assertNear(p.peakForce, 10.5f * GRAVITY, 0.01);
+    assertNear(p.peakStress, 10.5f * GRAVITY / AREA, 0.001);
+    assertNear(p.elongation, 10.2f, 0.001);
+    assertNear(p.strain, 10.2f / LENGTH * 100, 0.01);
+    // 25 kg mm elastic + 51.25 kg mm plastic
+    assertNear(p.energy, 76.25f * GRAVITY / 1000.0f, 0.001);
+}
+
+test(PropertiesCost)
+{
+    PropertyTracker tracker;
+    const int LOOPS = 20;
+    uint32_t c = micros();
+    for (int l = 0; l < LOOPS; l++)
+        run(tracker);
+    c = micros() - c;
+    Serial.printf("properties %.3fus per sample\n", c / float(LOOPS * 2101));
+
+    // never over the band, only the stiffness
+    tracker.begin(calibration.fromKg(1.0), calibration.fromKg(40.0), 100);
+    for (int i = 0; i < 1000; i++)
+        tracker.add(i * 5, calibration.fromKg(curve(i * 0.005f)));
+    TestProperties p = tracker.get(calibration, LENGTH, AREA);
+    assertFalse(tracker.hasFit());
+    assertNear(p.stiffness, 2.0f * GRAVITY, 0.01);
+    assertEqual(p.yieldForce, 0.0f);
+}
+
+void setup()
+{
+    delay(1000);
+    Serial.begin(115200);
+}
+
+void loop()
+{
+    aunit::TestRunner::run();
+}
@@ -5,6 +5,9 @@ NetworkManager network;
 void setup() {
     Serial.begin(115200);
     network.begin("miHostName");
+    network.setOnStatus([](NetworkManager::Status status) {
+        Serial.printf("wifi status %d at %dms\n", status, millis());
+    });
     network.connect("Zyxel_E49C", "^t!pcm774K");
 }
 
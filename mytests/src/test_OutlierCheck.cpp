@@ -0,0 +1,210 @@
+#include <AUnit.h>
+#include "OutlierCheck.h"
+
+const uint8_t BINS = TestAnalyzer::MAX_RESULT;
+DataArray<BINS, ResultBin> result;
+
+float noise(uint32_t &seed)
+{
+    seed = seed * 1664525 + 1013904223;
+    return (seed >> 8) / float(1 << 24) - 0.5;
+}
+
+// a specimen around 20kg and 3mm at the peak, triangle in time
+void makeRun(float *distance, float *force, uint32_t &seed, float peak = 20, float rupture = 3)
+{
+    const uint8_t peak_bin = TestAnalyzer::PEAK_BIN;
+    const float p = peak + noise(seed);
+    const float d = rupture + noise(seed) * 0.1;
+    for (uint8_t bin = 0; bin < BINS; bin++)
+    {
+        force[bin] = p * (1.0 - abs(bin - peak_bin) / 12.0) + noise(seed) * 0.2;
+        distance[bin] = d + (bin - peak_bin) * 0.02;
+    }
+}
+
+// a result and its band, without its runs
+void fill(uint8_t runs)
+{
+    uint32_t seed = 11;
+    float distance[BINS], force[BINS];
+    OutlierCheck::RunSet *set = new OutlierCheck::RunSet();
+    result.clear();
+    for (uint8_t i = 0; i < runs; i++)
+    {
+        makeRun(distance, force, seed);
+        TestAnalyzer::accumulate(result, TestAnalyzer::Grid(), distance, force);
+        set->add(distance, force);
+    }
+    set->setBand(result);
+    delete set;
+}
+
+test(OutlierCheckGood)
+{
+    fill(12);
+    uint32_t seed = 99;
+    float distance[BINS], force[BINS];
+    for (int i = 0; i < 10; i++)
+    {
+        makeRun(distance, force, seed);
+        OutlierReport report = OutlierCheck::check(result, distance, force);
+        assertTrue(report.checked);
+        assertFalse(report.outlier);
+    }
+}
+
+test(OutlierCheckPeak)
+{
+    fill(12);
+    uint32_t seed = 5;
+    float distance[BINS], force[BINS];
+    // slipped in the grip, 60% of the force
+    makeRun(distance, force, seed, 12);
+    OutlierReport report = OutlierCheck::check(result, distance, force);
+    assertTrue(report.outlier);
+    assertLess(report.peak, -3.5f);
+    assertMore(report.shape, 3.5f);
+}
+
+test(OutlierCheckDisplacement)
+{
+    fill(12);
+    uint32_t seed = 5;
+    float distance[BINS], force[BINS];
+    // same force, broken far later: the band is only of the force
+    makeRun(distance, force, seed, 20, 4);
+    OutlierReport report = OutlierCheck::check(result, distance, force);
+    assertTrue(report.checked);
+    assertFalse(report.outlier);
+    assertEqual(report.displacement, 0.0f);
+    assertLess(fabsf(report.peak), 3.5f);
+}
+
+test(OutlierCheckFewRuns)
+{
+    fill(2);
+    uint32_t seed = 5;
+    float distance[BINS], force[BINS];
+    makeRun(distance, force, seed, 5);
+    OutlierReport report = OutlierCheck::check(result, distance, force);
+    assertFalse(report.checked);
+    assertFalse(report.outlier);
+}
+
+// the same runs as fill(), as the store of the result keeps them
+void fillRuns(OutlierCheck::RunSet &set, uint8_t runs)
+{
+    uint32_t seed = 11;
+    float distance[BINS], force[BINS];
+    set = OutlierCheck::RunSet();
+    for (uint8_t i = 0; i < runs; i++)
+    {
+        makeRun(distance, force, seed);
+        set.add(distance, force);
+    }
+}
+
+test(OutlierCheckRuns)
+{
+    OutlierCheck::RunSet set;
+    fillRuns(set, 12);
+    uint32_t seed = 99;
+    float distance[BINS], force[BINS];
+    for (int i = 0; i < 10; i++)
+    {
+        makeRun(distance, force, seed);
+        OutlierReport report = OutlierCheck::check(set, distance, force);
+        assertTrue(report.checked);
+        assertFalse(report.outlier);
+    }
+
+    // slipped in the grip and broken later
+    seed = 5;
+    makeRun(distance, force, seed, 12);
+    OutlierReport report = OutlierCheck::check(set, distance, force);
+    assertTrue(report.outlier);
+    assertLess(report.peak, -3.5f);
+    assertMore(report.shape, 3.5f);
+    makeRun(distance, force, seed, 20, 4);
+    report = OutlierCheck::check(set, distance, force);
+    assertTrue(report.outlier);
+    assertMore(report.displacement, 3.5f);
+    assertLess(fabsf(report.peak), 3.5f);
+}
+
+test(OutlierCheckRunsMad)
+{
+    // 1, 2, 3, 4, 100 at the peak: median 3, MAD 1
+    OutlierCheck::RunSet set;
+    float distance[BINS], force[BINS];
+    const float peaks[] = {4, 1, 100, 3, 2};
+    for (float p : peaks)
+    {
+        for (uint8_t bin = 0; bin < BINS; bin++)
+        {
+            force[bin] = p;
+            distance[bin] = 3;
+        }
+        set.add(distance, force);
+    }
+    for (uint8_t bin = 0; bin < BINS; bin++)
+        force[bin] = 3 + 1.4826 * 2;
+    OutlierReport report = OutlierCheck::check(set, distance, force);
+    assertNear(report.peak, 2.0f, 0.001f);
+    assertNear(report.shape, 2.0f, 0.001f);
+    assertNear(report.displacement, 0.0f, 0.001f);
+}
+
+test(OutlierCheckRunsLast)
+{
+    // only the last MAX_RUNS are kept
+    OutlierCheck::RunSet set;
+    fillRuns(set, OutlierCheck::MAX_RUNS + 5);
+    assertEqual(set.runs, OutlierCheck::MAX_RUNS);
+    assertEqual(set.next, (uint8_t)5);
+
+    fillRuns(set, 2);
+    float distance[BINS], force[BINS];
+    uint32_t seed = 5;
+    makeRun(distance, force, seed, 5);
+    assertFalse(OutlierCheck::check(set, distance, force).checked);
+}
+
+test(OutlierCheckBand)
+{
+    // 1..10kg in every bin, the runs out of order
+    OutlierCheck::RunSet set;
+    float distance[BINS], force[BINS];
+    const float forces[] = {7, 2, 10, 4, 1, 9, 3, 6, 8, 5};
+    for (float f : forces)
+    {
+        for (uint8_t bin = 0; bin < BINS; bin++)
+        {
+            force[bin] = f;
+            distance[bin] = 3;
+        }
+        set.add(distance, force);
+    }
+    fill(1);
+    set.setBand(result);
+    // linear between the ranks
+    for (ResultBin *item : result)
+    {
+        assertEqual(item->bandCount, (uint16_t)10);
+        assertNear(item->p10, 1.9f, 0.0001f);
+        assertNear(item->p50, 5.5f, 0.0001f);
+        assertNear(item->p90, 9.1f, 0.0001f);
+    }
+}
+
+void setup()
+{
+    delay(1000);
+    Serial.begin(115200);
+}
+
+void loop()
+{
+    aunit::TestRunner::run();
+}
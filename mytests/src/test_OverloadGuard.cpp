@@ -0,0 +1,63 @@
+#include <AUnit.h>
+#include "OverloadGuard.h"
+
+test(OverloadGuardTrip)
+{
+    OverloadGuard guard;
+    // disabled
+    assertFalse(guard.check(1000000, 1));
+
+    guard.setLimit(10000);
+    assertFalse(guard.check(9999, 1));
+    // trips once when crossing the limit
+    assertTrue(guard.check(10001, 1));
+    assertEqual(guard.getTrips(), (uint32_t)1);
+
+    // still over the limit: stopped, not moving, or unloading
+    assertFalse(guard.check(10500, 0));
+    assertFalse(guard.check(10500, -1));
+    // moving again against the limit is stopped
+    assertTrue(guard.check(10500, 1));
+    assertEqual(guard.getBlocked(), (uint32_t)1);
+    assertEqual(guard.getTrips(), (uint32_t)1);
+    assertEqual(guard.getPeak(), (int32_t)10500);
+
+    // hysteresis, released below 90%, the next crossing is a new trip
+    assertTrue(guard.check(9500, 1));
+    assertFalse(guard.check(8999, 1));
+    assertTrue(guard.check(10001, -1));
+    assertEqual(guard.getTrips(), (uint32_t)2);
+}
+
+test(OverloadGuardTripAtRest)
+{
+    OverloadGuard guard;
+    guard.setLimit(10000);
+    // loaded moving down, the cell goes over the limit once stopped (creep)
+    assertFalse(guard.check(9000, -1));
+    assertTrue(guard.check(10001, 0));
+    assertTrue(guard.check(10200, -1));
+    assertFalse(guard.check(10200, 1));
+
+    // never moved, the loading direction is unknown: both are stopped
+    OverloadGuard idle;
+    idle.setLimit(10000);
+    assertTrue(idle.check(10001, 0));
+    assertTrue(idle.check(10001, 1));
+    assertTrue(idle.check(10001, -1));
+    assertEqual(idle.getBlocked(), (uint32_t)2);
+    // until it is released
+    assertFalse(idle.check(8999, 0));
+    assertFalse(idle.check(8999, 1));
+}
+
+void setup()
+{
+    delay(1000);
+    Serial.begin(115200);
+}
+
+void loop()
+{
+    aunit::TestRunner::run();
+}
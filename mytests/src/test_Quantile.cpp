@@ -0,0 +1,170 @@
+#include <AUnit.h>
+#include <algorithm>
+#include "data.h"
+
+const int VALUES = 2000;
+
+// exact quantile of the sorted values, same rank as the markers
+float exact(float *sorted, int n, float p)
+{
+    return sorted[int(lroundf(p * (n - 1)))];
+}
+
+float uniform(uint32_t &seed)
+{
+    seed = seed * 1664525 + 1013904223;
+    return (seed >> 8) / float(1 << 24);
+}
+
+test(QuantileSmall)
+{
+    // up to 5 values the estimate is exact
+    P2Quantile q(0.5);
+    assertEqual(q.get(), 0.0f);
+    q.add(30);
+    q.add(10);
+    q.add(20);
+    assertEqual(q.getCount(), (uint16_t)3);
+    assertEqual(q.get(), 20.0f);
+
+    P2Quantile q90(0.9);
+    const float values[] = {5, 1, 4, 2, 3};
+    for (float v : values)
+        q90.add(v);
+    assertEqual(q90.get(), 5.0f);
+}
+
+test(QuantileAccuracy)
+{
+    static float values[VALUES];
+    P2Quantile p10(0.1), p50(0.5), p90(0.9);
+    uint32_t seed = 7;
+    // forces of many tests, normal-ish around 20kg plus a few outliers
+    for (int i = 0; i < VALUES; i++)
+    {
+        float v = 20 + (uniform(seed) + uniform(seed) + uniform(seed) - 1.5);
+        if (i % 100 == 0)
+            v = 60;
+        values[i] = v;
+        p10.add(v);
+        p50.add(v);
+        p90.add(v);
+    }
+    std::sort(values, values + VALUES);
+    assertNear(p10.get(), exact(values, VALUES, 0.1), 0.05);
+    assertNear(p50.get(), exact(values, VALUES, 0.5), 0.05);
+    assertNear(p90.get(), exact(values, VALUES, 0.9), 0.05);
+    // the outliers do not move the band, the max goes to 60
+    assertLess(p90.get(), 21.0f);
+}
+
+test(QuantileState)
+{
+    P2Quantile a(0.9), b(0.9);
+    uint32_t seed = 3;
+    for (int i = 0; i < 100; i++)
+        a.add(uniform(seed));
+
+    // saved and loaded in the middle, same estimate after more values
+    float state[P2Quantile::STATE_SIZE];
+    a.getState(state);
+    assertTrue(b.setState(state));
+    for (int i = 0; i < 100; i++)
+    {
+        float v = uniform(seed);
+        a.add(v);
+        b.add(v);
+    }
+    assertEqual(a.get(), b.get());
+    assertEqual(b.getCount(), (uint16_t)200);
+
+    // positions out of order
+    state[6] = state[7] + 1;
+    assertFalse(b.setState(state));
+    assertEqual(b.getCount(), (uint16_t)0);
+}
+
+test(QuantileResultBinLegacy)
+{
+    // a result saved with the state of the estimators
+    P2Quantile quantiles[] = {P2Quantile(0.1), P2Quantile(0.5), P2Quantile(0.9)};
+    JsonDocument doc;
+    JsonObject obj = doc.to<JsonObject>();
+    obj["d"] = 1.0;
+    obj["f"] = 9.5;
+    obj["t"] = 0;
+    obj["n"] = 20;
+    obj["m2"] = 665.0;
+    JsonArray qs = obj["qs"].to<JsonArray>();
+    for (P2Quantile &q : quantiles)
+    {
+        for (int i = 0; i < 20; i++)
+            q.add(i);
+        float state[P2Quantile::STATE_SIZE];
+        q.getState(state);
+        JsonArray arr = qs.add<JsonArray>();
+        for (float v : state)
+            arr.add(v);
+    }
+
+    // its band is what the estimators had, no state is kept
+    ResultBin loaded;
+    assertTrue(loaded.deserializeItem(obj));
+    assertEqual(loaded.count, (uint16_t)20);
+    assertEqual(loaded.bandCount, (uint16_t)20);
+    assertNear(loaded.p10, quantiles[0].get(), 0.0001f);
+    assertNear(loaded.p50, quantiles[1].get(), 0.0001f);
+    assertNear(loaded.p90, quantiles[2].get(), 0.0001f);
+
+    JsonDocument file;
+    JsonObject f = file.to<JsonObject>();
+    loaded.serializeItem(f);
+    assertFalse(f["qs"].is<JsonArray>());
+    assertEqual(f["bn"].as<uint16_t>(), (uint16_t)20);
+}
+
+test(QuantileResultBinClient)
+{
+    ResultBin item;
+    item.resetStats();
+    for (int i = 0; i < 20; i++)
+        item.accumulate(1.0, i);
+    item.setBand(1.9, 9.5, 17.1, 20);
+
+    JsonDocument file, client;
+    JsonObject f = file.to<JsonObject>();
+    JsonObject c = client.to<JsonObject>();
+    item.serializeItem(f);
+    item.serializeItem(c, true);
+
+    // the band to both, what is needed for the next run only to the file
+    assertTrue(f["m2"].is<float>());
+    assertTrue(f["bn"].is<uint16_t>());
+    assertFalse(c["m2"].is<float>());
+    assertFalse(c["bn"].is<uint16_t>());
+    assertEqual(c["n"].as<uint16_t>(), (uint16_t)20);
+    assertNear(c["p50"].as<float>(), 9.5f, 0.01f);
+
+    ResultBin loaded;
+    assertTrue(loaded.deserializeItem(f));
+    assertEqual(loaded.bandCount, (uint16_t)20);
+    assertNear(loaded.p10, 1.9f, 0.01f);
+    assertNear(loaded.p90, 17.1f, 0.01f);
+}
+
+test(QuantileRawSample)
+{
+    // a bin keeps its band, not the state of the estimators
+    assertLess(sizeof(ResultBin) - sizeof(SensorItem), sizeof(P2Quantile));
+}
+
+void setup()
+{
+    delay(1000);
+    Serial.begin(115200);
+}
+
+void loop()
+{
+    aunit::TestRunner::run();
+}
@@ -0,0 +1,112 @@
+#include <AUnit.h>
+#include <inttypes.h>
+#include "Resampler.h"
+
+// curve computed on the fly, 100k samples do not fit in the RAM of the ESP32
+struct SyntheticCurve
+{
+    uint32_t count = 0;
+
+    uint32_t size() { return count; }
+    // 80hz with jitter
+    int64_t time(uint32_t i) { return i * 12500LL + (i * 7919 % 13) * 200; }
+    float distance(uint32_t i) { return i * 0.0021f; }
+    int32_t force(uint32_t i) { return i < count * 3 / 4 ? i * 40 : 0; }
+};
+
+// the old addTest(): a search from the start for every target
+template <class Source>
+int32_t searchForce(Source &source, int64_t target)
+{
+    uint32_t size = source.size();
+    uint32_t i = 0;
+    while (i < size && source.time(i) <= target)
+        i++;
+    uint32_t prev = i == 0 ? 0 : (i == size ? size - 2 : i - 1);
+    int64_t span = source.time(prev + 1) - source.time(prev);
+    int64_t delta = int64_t(source.force(prev + 1) - source.force(prev)) * (target - source.time(prev));
+    delta += (delta < 0 ? -span : span) / 2;
+    return source.force(prev) + delta / span;
+}
+
+test(ResamplerMatchesSearch)
+{
+    SyntheticCurve curve;
+    curve.count = 1000;
+    Resampler<SyntheticCurve> walk(curve);
+
+    // from before the first sample to after the last one
+    for (int64_t t = -50000; t < curve.time(999) + 50000; t += 3333)
+    {
+        assertTrue(walk.seek(t));
+        int32_t f = walk.interpolate(curve.force(walk.prev()), curve.force(walk.next()));
+        assertEqual(f, searchForce(curve, t));
+    }
+
+    // exact on the samples
+    walk.rewind();
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        walk.seek(curve.time(i));
+        assertNear(walk.interpolate(curve.distance(walk.prev()), curve.distance(walk.next())),
+                   curve.distance(i), 1e-5);
+    }
+
+    SyntheticCurve empty;
+    Resampler<SyntheticCurve> none(empty);
+    assertFalse(none.seek(0));
+}
+
+// on the board with env:mytests, on the PC with env:native (platformio.ini)
+test(ResamplerBench)
+{
+    // grid of a result (16 targets every 20ms) around the rupture at 3/4,
+    // and every 20ms of the whole test like an export
+    SyntheticCurve curve;
+    volatile int32_t sink = 0;
+
+    for (uint32_t samples : {1000, 10000, 100000})
+    {
+        curve.count = samples;
+        int64_t rupture = curve.time(samples * 3 / 4);
+        int64_t end = curve.time(samples - 1);
+
+        uint32_t c = micros();
+        for (int k = 0; k < 16; k++)
+            sink = sink + searchForce(curve, rupture - 200000 + k * 20000);
+        uint32_t tSearch = micros() - c;
+
+        c = micros();
+        Resampler<SyntheticCurve> walk(curve);
+        for (int k = 0; k < 16; k++)
+        {
+            walk.seek(rupture - 200000 + k * 20000);
+            sink = sink + walk.interpolate(curve.force(walk.prev()), curve.force(walk.next()));
+        }
+        uint32_t tWalk = micros() - c;
+
+        c = micros();
+        walk.rewind();
+        uint32_t targets = 0;
+        for (int64_t t = 0; t <= end; t += 20000, targets++)
+        {
+            walk.seek(t);
+            sink = sink + walk.interpolate(curve.force(walk.prev()), curve.force(walk.next()));
+        }
+        uint32_t tExport = micros() - c;
+
+        Serial.printf("%6" PRIu32 " samples: result search %7" PRIu32 "us, walk %6" PRIu32 "us | export %" PRIu32 " targets walk %6" PRIu32 "us\n",
+                      samples, tSearch, tWalk, targets, tExport);
+    }
+}
+
+void setup()
+{
+    delay(1000);
+    Serial.begin(115200);
+}
+
+void loop()
+{
+    aunit::TestRunner::run();
+}
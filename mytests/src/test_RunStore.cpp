@@ -0,0 +1,124 @@
+#include <AUnit.h>
+#include "TestAnalyzer.h"
+#include "RunStore.h"
+
+typedef RunStore<TestAnalyzer::MAX_RESULT> Runs;
+Runs store;
+const char *PATH = "/data/test_runs.runs";
+const char *LEGACY_PATH = "/data/test_legacy.runs";
+const uint16_t RUNS = 120;
+// the grid of a test of 30s with the peak at 25s, a band of 400ms before and 200ms after
+const TestAnalyzer::Grid grid(-25000, 5000, 400, 200);
+
+// run k, a triangle with the peak scaled by k
+void makeRun(uint16_t k, Runs::Record &run)
+{
+    for (uint8_t bin = 0; bin < TestAnalyzer::MAX_RESULT; bin++)
+    {
+        run.distance[bin] = bin * 0.1 + k * 0.001;
+        run.force[bin] = (10 + k % 7) * (1.0 - abs(bin - 10) / 10.0);
+    }
+    run.length = 5;
+    run.area = 2;
+}
+
+test(RunStoreAppend)
+{
+    assertTrue(store.create(PATH, grid.times));
+    Runs::Record run;
+    for (uint16_t k = 0; k < RUNS; k++)
+    {
+        makeRun(k, run);
+        assertTrue(store.append(PATH, run));
+    }
+
+    RunStoreHeader header;
+    assertTrue(store.getHeader(PATH, header));
+    assertEqual(header.bins, (uint16_t)TestAnalyzer::MAX_RESULT);
+    assertEqual(header.legacy, (uint16_t)0);
+    // the same bins, whatever the band of the grid
+    TestAnalyzer::Grid saved;
+    assertTrue(store.getTimes(PATH, saved.times));
+    for (uint8_t bin = 0; bin < TestAnalyzer::MAX_RESULT; bin++)
+        assertEqual(saved[bin], grid[bin]);
+
+    uint16_t seen = 0;
+    int32_t total = store.forEach(PATH, [&](uint16_t i, Runs::Record &record)
+    {
+        makeRun(i, run);
+        if (record.force[10] == run.force[10] && record.distance[3] == run.distance[3] && !record.isExcluded())
+            seen++;
+    });
+    assertEqual(total, (int32_t)RUNS);
+    assertEqual(seen, RUNS);
+}
+
+test(RunStoreRecompute)
+{
+    // the same average as adding the runs one by one, without the excluded
+    DataArray<TestAnalyzer::MAX_RESULT, ResultBin> incremental, recomputed;
+    Runs::Record run;
+    for (uint16_t k = 0; k < RUNS; k++)
+    {
+        makeRun(k, run);
+        if (k % 10 != 3)
+            TestAnalyzer::accumulate(incremental, grid, run.distance, run.force);
+    }
+
+    for (uint16_t k = 3; k < RUNS; k += 10)
+        assertTrue(store.setExcluded(PATH, k, true));
+    assertFalse(store.setExcluded(PATH, RUNS, true));
+
+    uint32_t start = millis();
+    uint16_t included = 0;
+    store.forEach(PATH, [&](uint16_t i, Runs::Record &record)
+    {
+        if (!record.isExcluded())
+        {
+            TestAnalyzer::accumulate(recomputed, grid, record.distance, record.force);
+            included++;
+        }
+    });
+    Serial.printf("recompute %d runs %d ms\n", RUNS, millis() - start);
+
+    assertEqual(included, (uint16_t)(RUNS - RUNS / 10));
+    for (uint8_t bin = 0; bin < TestAnalyzer::MAX_RESULT; bin++)
+    {
+        assertEqual(recomputed[bin]->count, incremental[bin]->count);
+        assertNear(recomputed[bin]->force, incremental[bin]->force, 0.0001);
+        assertNear(recomputed[bin]->m2, incremental[bin]->m2, 0.001);
+    }
+
+    // back in the average
+    assertTrue(store.setExcluded(PATH, 3, false));
+    uint16_t excluded = 0;
+    store.forEach(PATH, [&](uint16_t i, Runs::Record &record)
+    {
+        excluded += record.isExcluded();
+    });
+    assertEqual(excluded, (uint16_t)(RUNS / 10 - 1));
+}
+
+test(RunStoreLegacy)
+{
+    // a result saved before the store, 4 runs only in its summary
+    assertTrue(store.create(LEGACY_PATH, grid.times, 4));
+    RunStoreHeader header;
+    assertTrue(store.getHeader(LEGACY_PATH, header));
+    assertEqual(header.legacy, (uint16_t)4);
+    LittleFS.remove(LEGACY_PATH);
+    assertFalse(store.getHeader(LEGACY_PATH, header));
+    assertEqual(store.forEach(LEGACY_PATH, [](uint16_t i, Runs::Record &record) {}), (int32_t)-1);
+}
+
+void setup()
+{
+    delay(1000);
+    Serial.begin(115200);
+    LittleFS.begin(true);
+}
+
+void loop()
+{
+    aunit::TestRunner::run();
+}
@@ -0,0 +1,144 @@
+#include <AUnit.h>
+#include "data.h"
+#include "SampleBuffer.h"
+
+// 1000 samples, the old raw data of TestAnalyzer against the columns
+const uint SAMPLES = 1000;
+DataArray<SAMPLES, SensorItem> items;
+SampleBuffer<SAMPLES> columns;
+
+// net counts, 10000 counts/kg
+int32_t curve(int i)
+{
+    return i < 800 ? i * 300 : 10000;
+}
+
+void fill()
+{
+    items.clear();
+    columns.clear();
+    for (int i = 0; i < SAMPLES; i++)
+    {
+        int64_t t = i * 12500LL + (i % 7) * 300;
+        SensorItem *item = items.getEmpty();
+        item->setSample(i * 0.0021f, curve(i) / 10000.0f, t);
+        items.push(item);
+        columns.push(t, i * 0.0021f, curve(i));
+    }
+}
+
+test(SampleBufferValues)
+{
+    fill();
+    assertEqual(columns.size(), (uint32_t)SAMPLES);
+    for (int i = 0; i < SAMPLES; i++)
+    {
+        assertEqual(columns.time(i), items[i]->timestamp);
+        // distance quantized to nm, force kept in counts
+        assertNear(columns.distance(i), items[i]->distance, 1e-5);
+        assertEqual(columns.force(i), curve(i));
+    }
+    // the same as the walk over the items
+    for (int i = 0; i < SAMPLES; i += 37)
+    {
+        uint32_t k = 0;
+        while (k < SAMPLES && items[k]->timestamp <= items[i]->timestamp + 5000)
+            k++;
+        assertEqual(columns.upperBound(items[i]->timestamp + 5000), k);
+    }
+    assertEqual(columns.upperBound(-1), (uint32_t)0);
+    assertEqual(columns.upperBound(SAMPLES * 12500LL), (uint32_t)SAMPLES);
+
+    // ring, the oldest is overwritten
+    assertTrue(columns.push(SAMPLES * 12500LL, 0.0, 50000));
+    assertEqual(columns.time(0), items[1]->timestamp);
+    assertEqual(columns.force(SAMPLES - 1), (int32_t)50000);
+}
+
+test(SampleBufferRebase)
+{
+    SampleBuffer<4> buffer;
+    // esp_timer after 1 hour, more than int32 us
+    int64_t t = 3600LL * 1000000LL;
+    for (int i = 0; i < 100; i++)
+    {
+        t += 30LL * 1000000LL;
+        buffer.push(t, i, i);
+    }
+    assertEqual(buffer.time(3), t);
+    assertEqual(buffer.time(0), t - 90LL * 1000000LL);
+}
+
+// on the board with env:mytests, on the PC with env:native and this file
+// in its build_src_filter (platformio.ini)
+test(SampleBufferBench)
+{
+    fill();
+    const int LOOPS = 100;
+
+    size_t memItems = sizeof(items) + SAMPLES * sizeof(SensorItem *);
+    size_t memColumns = sizeof(columns);
+    Serial.printf("memory %u samples: DataArray<SensorItem> %u bytes, SampleBuffer %u bytes\n",
+                  SAMPLES, (unsigned)memItems, (unsigned)memColumns);
+    assertLess(memColumns * 3, memItems);
+
+    // max force, old detect_rupture()
+    uint32_t c = micros();
+    size_t maxItem = 0;
+    for (int l = 0; l < LOOPS; l++)
+    {
+        float max = 0;
+        for (size_t i = 0; i < items.size(); ++i)
+            if (items[i]->force > max)
+            {
+                max = items[i]->force;
+                maxItem = i;
+            }
+    }
+    uint32_t tItems = micros() - c;
+
+    c = micros();
+    uint32_t maxColumn = 0;
+    for (int l = 0; l < LOOPS; l++)
+        maxColumn = columns.maxForce();
+    uint32_t tColumns = micros() - c;
+
+    assertEqual((uint32_t)maxItem, maxColumn);
+    Serial.printf("max force scan: DataArray %.2fus, SampleBuffer %.2fus\n",
+                  tItems / float(LOOPS), tColumns / float(LOOPS));
+
+    // search by time, calculate_force() of the 16 points of a result
+    int64_t target = columns.time(maxColumn) - 200000;
+    c = micros();
+    volatile uint32_t found = 0;
+    for (int l = 0; l < LOOPS; l++)
+        for (int k = 0; k < 16; k++)
+            for (SensorItem *item : items)
+                if (item->timestamp > target + k * 20000)
+                {
+                    found = found + 1;
+                    break;
+                }
+    tItems = micros() - c;
+
+    c = micros();
+    for (int l = 0; l < LOOPS; l++)
+        for (int k = 0; k < 16; k++)
+            found = found + columns.upperBound(target + k * 20000);
+    tColumns = micros() - c;
+
+    Serial.printf("time search x16: DataArray %.2fus, SampleBuffer %.2fus\n",
+                  tItems / float(LOOPS), tColumns / float(LOOPS));
+    assertLess(tColumns, tItems);
+}
+
+void setup()
+{
+    delay(1000);
+    Serial.begin(115200);
+}
+
+void loop()
+{
+    aunit::TestRunner::run();
+}
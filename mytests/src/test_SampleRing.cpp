@@ -0,0 +1,61 @@
+#include <AUnit.h>
+#include <SampleRing.h>
+
+struct Sample
+{
+    int64_t time;
+    int32_t raw;
+};
+
+SampleRing<Sample, 8> ring;
+
+test(SampleRingFill)
+{
+    Sample s;
+    ring.clear();
+    assertTrue(ring.isEmpty());
+    assertFalse(ring.pop(s));
+
+    for (int i = 0; i < 8; i++)
+        assertTrue(ring.push({i * 12500, i}));
+
+    // full, the new sample is dropped
+    assertFalse(ring.push({100, 100}));
+    assertEqual(ring.getDropped(), (uint32_t)1);
+    assertEqual(ring.size(), (uint32_t)8);
+
+    for (int i = 0; i < 8; i++)
+    {
+        assertTrue(ring.pop(s));
+        assertEqual(s.raw, i);
+    }
+    assertTrue(ring.isEmpty());
+}
+
+test(SampleRingWrap)
+{
+    Sample s;
+    ring.clear();
+    // indexes go around the buffer many times
+    for (int i = 0; i < 1000; i++)
+    {
+        assertTrue(ring.push({i, i}));
+        assertTrue(ring.push({i, -i}));
+        assertTrue(ring.pop(s));
+        assertEqual(s.raw, i);
+        assertTrue(ring.pop(s));
+        assertEqual(s.raw, -i);
+    }
+    assertTrue(ring.isEmpty());
+}
+
+void setup()
+{
+    delay(1000);
+    Serial.begin(115200);
+}
+
+void loop()
+{
+    aunit::TestRunner::run();
+}
@@ -0,0 +1,125 @@
+#include <AUnit.h>
+#include "StreamFilter.h"
+
+const int32_t STEP = 10000;
+const int STEP_AT = 20;
+
+// output of the filter for a step from 0 to STEP at sample STEP_AT
+void stepResponse(StreamFilter &filter, int32_t *out, int n)
+{
+    filter.reset();
+    for (int i = 0; i < n; i++)
+        out[i] = filter.update(i < STEP_AT ? 0 : STEP);
+}
+
+test(StreamFilterNone)
+{
+    StreamFilter filter;
+    assertTrue(filter.begin(StreamFilter::NONE, 0));
+    assertEqual(filter.update(123), (int32_t)123);
+    assertFalse(filter.begin(StreamFilter::MEDIAN, StreamFilter::MAX_SIZE + 1));
+    assertEqual(filter.getType(), StreamFilter::NONE);
+
+    StreamFilter::Type type;
+    assertTrue(StreamFilter::parseType("iir", type));
+    assertEqual(type, StreamFilter::IIR);
+    assertFalse(StreamFilter::parseType("kalman", type));
+}
+
+test(StreamFilterMedianStep)
+{
+    StreamFilter filter;
+    int32_t out[40];
+    filter.begin(StreamFilter::MEDIAN, 5);
+    stepResponse(filter, out, 40);
+
+    // a clean step, delayed half the window
+    assertEqual(out[STEP_AT + 1], (int32_t)0);
+    assertEqual(out[STEP_AT + 2], STEP);
+    assertEqual(out[39], STEP);
+
+    // a spike of 2 samples is removed
+    filter.reset();
+    for (int i = 0; i < 20; i++)
+    {
+        int32_t v = filter.update((i == 10 || i == 11) ? 50000 : 100);
+        assertEqual(v, (int32_t)100);
+    }
+}
+
+test(StreamFilterIirStep)
+{
+    StreamFilter filter;
+    int32_t out[100];
+    filter.begin(StreamFilter::IIR, 9); // alpha 0.2
+    stepResponse(filter, out, 100);
+
+    assertEqual(out[STEP_AT - 1], (int32_t)0);
+    // 1 - 0.8^n
+    assertNear(out[STEP_AT], (int32_t)2000, (int32_t)2);
+    assertNear(out[STEP_AT + 4], (int32_t)6723, (int32_t)2);
+    for (int i = STEP_AT + 1; i < 100; i++)
+        assertTrue(out[i] >= out[i - 1]);
+    assertEqual(out[99], STEP);
+
+    // and back to zero
+    for (int i = 0; i < 100; i++)
+        filter.update(0);
+    assertEqual(filter.update(0), (int32_t)0);
+}
+
+test(StreamFilterFirStep)
+{
+    StreamFilter filter;
+    int32_t out[40];
+    filter.begin(StreamFilter::FIR, 5); // weights 1 2 3 2 1
+    stepResponse(filter, out, 40);
+
+    assertEqual(out[STEP_AT - 1], (int32_t)0);
+    assertEqual(out[STEP_AT], (int32_t)1111);
+    assertEqual(out[STEP_AT + 1], (int32_t)3333);
+    assertEqual(out[STEP_AT + 2], (int32_t)6667);
+    assertEqual(out[STEP_AT + 4], STEP);
+    // the size is odd
+    filter.begin(StreamFilter::FIR, 4);
+    assertEqual(filter.getSize(), (uint8_t)5);
+}
+
+test(StreamFilterBench)
+{
+    const int SAMPLES = 20000;
+    const char *names[] = {"none", "median", "iir", "fir"};
+    StreamFilter filter;
+    volatile int32_t sink = 0;
+
+    for (uint8_t t = StreamFilter::NONE; t <= StreamFilter::FIR; t++)
+    {
+        for (uint8_t size : {5, 15})
+        {
+            filter.begin((StreamFilter::Type)t, size);
+            uint32_t seed = 1;
+            uint32_t c = micros();
+            for (int i = 0; i < SAMPLES; i++)
+            {
+                // noisy ramp of the HX711
+                seed = seed * 1664525 + 1013904223;
+                sink = sink + filter.update(i * 20 + (int32_t)(seed >> 22) - 512);
+            }
+            c = micros() - c;
+            Serial.printf("%-6s size %2d: %.3fus per sample\n", names[t], size, c / float(SAMPLES));
+            // 80hz leaves 12.5ms per sample
+            assertLess(c / float(SAMPLES), 50.0f);
+        }
+    }
+}
+
+void setup()
+{
+    delay(1000);
+    Serial.begin(115200);
+}
+
+void loop()
+{
+    aunit::TestRunner::run();
+}
@@ -0,0 +1,69 @@
+#include <AUnit.h>
+#include "Tare.h"
+
+test(TareAverage)
+{
+    Tare tare;
+    tare.start(10, 0);
+    assertTrue(tare.isRunning());
+    for (int i = 0; i < 9; i++)
+        assertFalse(tare.add(1000 + (i % 2 ? 50 : -50)));
+    assertTrue(tare.add(1000));
+    assertEqual(tare.getState(), Tare::DONE);
+    assertEqual(tare.getOffset(), (int32_t)995);
+    // no more samples taken
+    assertFalse(tare.add(5000));
+    assertFalse(tare.update(100000));
+}
+
+test(TareTimeout)
+{
+    Tare tare;
+    tare.start(10, 1000);
+    tare.add(1000);
+    assertFalse(tare.update(2000));
+    assertTrue(tare.update(3001));
+    assertEqual(tare.getState(), Tare::FAILED);
+    tare.clear();
+    assertFalse(tare.isRunning());
+}
+
+test(BaselineTracker)
+{
+    BaselineTracker baseline;
+    baseline.setBand(100);
+    uint32_t now = 0;
+    assertFalse(baseline.isFresh(now, 5000));
+
+    // at rest with noise
+    for (int i = 0; i < 64; i++)
+        baseline.add(2000 + (i % 3) * 20, now += 12);
+    assertTrue(baseline.isFresh(now, 5000));
+    assertNear(baseline.getOffset(), (int32_t)2020, (int32_t)1);
+
+    // a load is applied, the moving blocks are not taken
+    for (int i = 0; i < 64; i++)
+        baseline.add(2000 + i * 500, now += 12);
+    assertNear(baseline.getOffset(), (int32_t)2020, (int32_t)1);
+    assertFalse(baseline.isFresh(now, 500));
+
+    // slow drift at rest is followed
+    for (int b = 0; b < 20; b++)
+        for (int i = 0; i < BaselineTracker::BLOCK_SAMPLES; i++)
+            baseline.add(2080, now += 12);
+    assertNear(baseline.getOffset(), (int32_t)2080, (int32_t)4);
+
+    baseline.reset();
+    assertFalse(baseline.isFresh(now, 5000));
+}
+
+void setup()
+{
+    delay(1000);
+    Serial.begin(115200);
+}
+
+void loop()
+{
+    aunit::TestRunner::run();
+}
@@ -385,6 +385,167 @@ test(testResultTest)
 }
 */
 
+/********************
+	free slots
+********************/
+test(DataArraySlots)
+{
+	DataArray<40, MyItem> array;
+
+	// the same item until it is pushed, the lowest free one
+	MyItem *first = array.getEmpty();
+	assertTrue(first == array.getEmpty());
+	first->set(-1, 1, "a");
+	assertTrue(array.push(first));
+	MyItem *second = array.getEmpty();
+	assertTrue(second != first);
+	while (MyItem *item = array.getEmpty())
+	{
+		item->set(-1, 2, "b");
+		array.push(item);
+	}
+	assertEqual((int)array.size(), 40);
+
+	// a removed item is the next one
+	MyItem *item = array[33];
+	assertTrue(array.remove(item));
+	assertTrue(array.getEmpty() == item);
+	assertTrue(array.pop());
+	assertTrue(array.getEmpty() == item);
+
+	// an item taken by a failed create is skipped, as the scan did
+	item->id = 7;
+	assertTrue(array.getEmpty() != item);
+
+	array.clear();
+	assertTrue(array.getEmpty() == first);
+	assertTrue(item->id == Item::CREATE_NEW);
+}
+
+test(DataTableIds)
+{
+	DataTable<40, MyItem> table;
+
+	// the lowest free id, over the two words of the bitmap
+	for (uint32_t i = 0; i < 40; i++)
+	{
+		MyItem *item = table.getEmpty();
+		item->set(-1, i, "id");
+		assertTrue(table.push(item));
+		assertEqual(item->id, i);
+	}
+	assertFalse(table.getEmpty());
+
+	// a removed id is given again
+	assertTrue(table.remove(35));
+	assertTrue(table.remove(3));
+	assertFalse(table.remove(3));
+	MyItem *item = table.getEmpty();
+	item->set(-1, 0, "again");
+	table.push(item);
+	assertEqual(item->id, (uint32_t)3);
+	item = table.getEmpty();
+	item->set(-1, 0, "again");
+	table.push(item);
+	assertEqual(item->id, (uint32_t)35);
+
+	// a missing key is not added by a lookup
+	table.clear();
+	assertFalse(table[5]);
+	assertEqual((int)table.size(), 0);
+
+	// explicit ids of a file, the new ones take the holes
+	String json = "[{\"id\":1,\"edad\":21,\"name\":\"a\"},{\"id\":2,\"edad\":22,\"name\":\"b\"},{\"id\":100,\"edad\":23,\"name\":\"c\"}]";
+	assertTrue(table.deserializeData(json));
+	assertEqual((int)table.size(), 3);
+	uint32_t expected[] = {0, 3, 4};
+	for (uint32_t id : expected)
+	{
+		item = table.getEmpty();
+		item->set(-1, 0, "new");
+		table.push(item);
+		assertEqual(item->id, id);
+	}
+	assertTrue(table[100]);
+}
+
+// the old getEmpty(), a scan of the items, for the benchmark
+template <class Base>
+class ScanData : public Base
+{
+public:
+	typedef decltype(Base().getEmpty()) Pointer;
+	Pointer getEmpty()
+	{
+		const int n = sizeof(this->items) / sizeof(this->items[0]);
+		for (int i = 0; i < n; i++)
+			if (this->items[i].id == Item::CREATE_NEW)
+				return &this->items[i];
+		return nullptr;
+	}
+};
+
+struct BenchItem : public Item
+{
+	uint32_t value = 0;
+	void serializeItem(JsonObject &obj, bool extra) { obj["v"] = value; }
+	bool deserializeItem(JsonObject &obj) { return true; }
+};
+
+const int BENCH = 512;
+DataArray<BENCH, BenchItem> benchArray;
+ScanData<DataArray<BENCH, BenchItem>> scanArray;
+DataList<BENCH, BenchItem> benchList;
+ScanData<DataList<BENCH, BenchItem>> scanList;
+
+// fill and clear, us per round
+template <class Data>
+float fillClear(Data &data, int rounds)
+{
+	uint32_t c = micros();
+	for (int r = 0; r < rounds; r++)
+	{
+		data.clear();
+		for (int i = 0; i < BENCH; i++)
+			data.push(data.getEmpty())->value = i;
+	}
+	return (micros() - c) / float(rounds);
+}
+
+// a full FIFO, the oldest goes and a new one comes, us per item
+template <class Data>
+float churn(Data &data, int loops)
+{
+	data.clear();
+	for (int i = 0; i < BENCH; i++)
+		data.push(data.getEmpty());
+	uint32_t c = micros();
+	for (int i = 0; i < loops; i++)
+	{
+		data.shift();
+		data.push(data.getEmpty())->value = i;
+	}
+	return (micros() - c) / float(loops);
+}
+
+// on the board with env:mytests, on the PC with env:native and this file
+// in its build_src_filter (platformio.ini)
+test(DataSlotsBench)
+{
+	const float fillBitmap = fillClear(benchArray, 20);
+	const float fillScan = fillClear(scanArray, 20);
+	Serial.printf("fill+clear %d items: bitmap %.0f us, scan %.0f us\n", BENCH, fillBitmap, fillScan);
+
+	const float churnBitmap = churn(benchList, 5000);
+	const float churnScan = churn(scanList, 5000);
+	Serial.printf("churn %d items: bitmap %.2f us, scan %.2f us per item\n", BENCH, churnBitmap, churnScan);
+
+	assertEqual((int)benchArray.size(), BENCH);
+	assertEqual((int)benchList.size(), BENCH);
+	assertFalse(benchList.getEmpty());
+	assertLess(fillBitmap, fillScan);
+}
+
 void setup() 
 {
 	delay(1000);
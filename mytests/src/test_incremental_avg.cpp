@@ -7,7 +7,7 @@ void print_stats(size_t num_tests = 0)
 {
     Serial.println("\n--- Estadísticas Actualizadas ---");
     Serial.println("TiempoRel | AvgDist | AvgForce (Min-Max)");
-    for (SensorItem *item : analyzer.accumulated_data)
+    for (ResultBin *item : analyzer.accumulated_data)
     {
         Serial.printf("%9d | %7.2f | %7.2f (%7.2f-%7.2f)\n",
                       item->time,
@@ -35,7 +35,7 @@ test(InterpTest)
     assertFalse(analyzer.isEmpty()); // Asegurarse de que los datos acumulados no estén vacíos
 
     // Buscar el punto de tiempo relativo 20
-    SensorItem *item = analyzer.getPoint(-40);
+    ResultBin *item = analyzer.getPoint(-40);
     // Verificar que el punto exista
     assertTrue(item);
     assertEqual(item->force, 21.0);
@@ -60,16 +60,493 @@ test(avgTest)
     print_stats(1);
 
     // Buscar el punto de tiempo relativo 0
-    SensorItem *item = analyzer.getPoint(0);
+    ResultBin *item = analyzer.getPoint(0);
     // Verificar que el punto exista
     assertTrue(item);
     assertEqual(item->force, ((item->max+item->min)/2.0));
 }
 
+test(calibrationTest)
+{
+    // fixed point against the float conversion of HX711::get_units()
+    Calibration cal;
+    const float factor = -2316138 / 44.34;
+    cal.set(-80000, factor);
+    for (int32_t raw = -8000000; raw < 8000000; raw += 99991)
+        assertNear(cal.toKg(cal.net(raw)), (raw + 80000) / factor, 0.0001);
+
+    // the same counts with a new factor, no precision lost
+    analyzer.clear();
+    analyzer.clearData();
+    analyzer.setCalibration(cal);
+    for (int i = 0; i < 20; i++)
+        analyzer.addRaw(i * 0.01, i < 10 ? i * 1000 : 0, i * 12500LL);
+    analyzer.addTest(0);
+    float before = analyzer.getPoint(-40)->force;
+
+    cal.set(-80000, factor * 2);
+    analyzer.clear();
+    analyzer.setCalibration(cal);
+    analyzer.addTest(0);
+    assertNear(analyzer.getPoint(-40)->force, before / 2, 0.0001);
+    analyzer.setCalibration(Calibration());
+}
+
+test(preTriggerTest)
+{
+    analyzer.clear();
+    analyzer.clearData();
+    // 2.5s ramp at 80hz before the trigger, only the last 2s are kept
+    // default calibration, 10000 counts/kg => 0.01kg per sample
+    const int64_t start = 1000000;
+    for (int i = 0; i < 200; i++)
+        analyzer.addPreTrigger(i * 0.001, i * 100, start + i * 12500);
+
+    // trigger on the last sample
+    analyzer.trigger(0.199, start + 199 * 12500);
+    assertTrue(analyzer.addSample(0.01, 3.0, 12500));
+    assertTrue(analyzer.addSample(0.02, 1.0, 25000));
+    assertTrue(analyzer.addSample(0.03, 0.2, 37500));
+
+    analyzer.addTest(0);
+    print_stats();
+
+    // rupture at 12.5ms, -200ms lands 15 samples before the trigger
+    ResultBin *item = analyzer.getPoint(-200);
+    assertTrue(item);
+    assertNear(item->force, 1.84, 0.001);
+    assertNear(item->distance, -0.015, 0.0001);
+}
+
+test(streamTest)
+{
+    analyzer.clear();
+    analyzer.clearData();
+    analyzer.setStream("/data/test_stream.bin");
+    analyzer.trigger(0.0, 0);
+    assertTrue(analyzer.isStreaming());
+
+    // 250s at 80hz, longer than the RAM window, the peak is at the start
+    for (int i = 0; i < 20000; i++)
+    {
+        float force = (i == 100) ? 30.0 : 10.0;
+        assertTrue(analyzer.addSample(i * 0.001, force, i * 12500LL));
+    }
+    analyzer.endStream();
+    analyzer.addTest(0);
+    print_stats();
+
+    // the window was kept around the peak while the samples arrived
+    ResultBin *item = analyzer.getPoint(0);
+    assertTrue(item);
+    assertNear(item->force, 30.0, 0.001);
+    item = analyzer.getPoint(-200);
+    assertNear(item->force, 10.0, 0.001);
+    assertNear(item->distance, 0.084, 0.0001);
+    LittleFS.remove("/data/test_stream.bin");
+}
+
+test(windowTest)
+{
+    analyzer.clear();
+    analyzer.clearData();
+    analyzer.setStream("");
+    analyzer.trigger(0.0, 0);
+    assertFalse(analyzer.isStreaming());
+
+    // 250s only in RAM, a triangle with the peak in the middle
+    for (int i = 0; i < 20000; i++)
+    {
+        float force = 30.0 - abs(i - 10000) * 0.1;
+        assertTrue(analyzer.addSample(i * 0.001, force, i * 12500LL));
+        // complete one sample after +100ms
+        if (i == 10008)
+            assertFalse(analyzer.isWindowReady());
+        if (i == 10009)
+            assertTrue(analyzer.isWindowReady());
+    }
+    analyzer.addTest(0);
+
+    // -200ms = 16 samples before the peak, +100ms = 8 after
+    assertNear(analyzer.getPoint(0)->force, 30.0, 0.001);
+    assertNear(analyzer.getPoint(-200)->force, 28.4, 0.001);
+    assertNear(analyzer.getPoint(-200)->distance, 9.984, 0.0001);
+    assertNear(analyzer.getPoint(100)->force, 29.2, 0.001);
+}
+
+test(timestampTest)
+{
+    analyzer.clear();
+    analyzer.clearData();
+    // samples with loop jitter, interpolation must use the real timestamps (us)
+    assertTrue(analyzer.addSample(0.0, 10.0, 0));
+    assertTrue(analyzer.addSample(1.0, 20.0, 13000));
+    assertTrue(analyzer.addSample(2.0, 40.0, 41000));
+    assertTrue(analyzer.addSample(3.0, 0.0, 47000));
+
+    analyzer.addTest(0);
+    print_stats();
+
+    // rupture at 41ms, -20ms => 21ms, between 13ms and 41ms
+    ResultBin *item = analyzer.getPoint(-20);
+    assertTrue(item);
+    assertNear(item->force, 20.0 + 20.0 * 8.0 / 28.0, 0.001);
+    assertNear(item->distance, 1.0 + 8.0 / 28.0, 0.001);
+}
+
+test(welfordTest)
+{
+    analyzer.clear();
+    // 5 tests, flat force with a peak in the middle
+    const float forces[] = {10.0, 12.0, 11.0, 15.0, 9.0};
+    for (uint8_t k = 0; k < 5; k++)
+    {
+        analyzer.clearData();
+        for (int i = 0; i < 40; i++)
+            assertTrue(analyzer.addSample(i * 0.01, i == 20 ? forces[k] + 5 : forces[k], i * 12500LL));
+        analyzer.addTest(k);
+    }
+    print_stats(4);
+
+    // the same as two passes over the tests
+    ResultBin *item = analyzer.getPoint(-200);
+    assertTrue(item);
+    assertEqual(item->count, (uint16_t)5);
+    assertNear(item->force, 11.4, 0.0001);
+    assertNear(item->variance(), 5.3, 0.0001);
+    assertNear(item->stddev(), sqrtf(5.3), 0.0001);
+    assertNear(item->min, 9.0, 0.0001);
+    assertNear(item->max, 15.0, 0.0001);
+
+    // a file without the count, migrated with the count of the history
+    item->count = 0;
+    item->m2 = 0;
+    analyzer.clearData();
+    for (int i = 0; i < 40; i++)
+        assertTrue(analyzer.addSample(i * 0.01, i == 20 ? 16.4 : 11.4, i * 12500LL));
+    analyzer.addTest(5);
+    assertEqual(item->count, (uint16_t)6);
+    assertNear(item->force, 11.4, 0.0001);
+    assertNear(item->m2, 2.4 * 2.4 + 3.6 * 3.6, 0.001);
+}
+
+test(migrateTest)
+{
+    // a result file saved before the count, 3 tests in the history
+    DataArray<TestAnalyzer::MAX_RESULT, ResultBin> result;
+    assertTrue(result.deserializeData(String("[{\"d\":1.0,\"f\":10.0,\"t\":-20,\"mi\":9.0,\"ma\":12.0},"
+                                             "{\"d\":2.0,\"f\":11.0,\"t\":0,\"mi\":11.0,\"ma\":11.0,\"n\":2,\"m2\":0.5}]")));
+    assertEqual(result[0]->count, (uint16_t)0);
+
+    // migrated when it's loaded, before any test is added
+    TestAnalyzer::migrate(result, 3);
+    assertEqual(result[0]->count, (uint16_t)3);
+    assertNear(result[0]->m2, 1.0 + 4.0, 0.0001);
+    assertNear(result[0]->stddev(), sqrtf(5.0 / 2), 0.0001);
+    // the bins with their count are kept
+    assertEqual(result[1]->count, (uint16_t)2);
+    assertNear(result[1]->m2, 0.5, 0.0001);
+
+    // and the client gets the count
+    JsonDocument doc;
+    JsonArray arr = doc.to<JsonArray>();
+    result.serializeData(arr, true);
+    assertEqual(arr[0]["n"].as<uint16_t>(), (uint16_t)3);
+}
+
+test(reloadTest)
+{
+    // a result saved and loaded again for every test it gets
+    ResultBin ram, file;
+    for (uint8_t k = 0; k < 50; k++)
+    {
+        const float distance = 1.0 + k * 0.000731, force = 10.0 + k * 0.0137 + (k % 7) * 0.00311;
+        ram.accumulate(distance, force);
+        file.accumulate(distance, force);
+        JsonDocument doc;
+        JsonObject obj = doc.to<JsonObject>();
+        file.serializeItem(obj);
+        file = ResultBin();
+        assertTrue(file.deserializeItem(obj));
+    }
+    // the file keeps the mean it had in RAM, no drift of the rounding
+    assertEqual(file.count, (uint16_t)50);
+    assertNear(file.force, ram.force, 0.00001);
+    assertNear(file.distance, ram.distance, 0.000001);
+    assertNear(file.m2, ram.m2, 0.0001);
+
+    // the clients get it rounded
+    JsonDocument doc;
+    JsonObject obj = doc.to<JsonObject>();
+    file.serializeItem(obj, true);
+    assertNear(obj["f"].as<float>(), round(ram.force * 100.0) / 100.0, 0.00001);
+}
+
+// force (kg) of sample i of a 25s test with the peak in the middle
+float gridCurve(int i)
+{
+    i = std::min(std::max(i, 0), 1999);
+    return 30.0 - abs(i - 1000) * 0.02;
+}
+
+test(gridTest)
+{
+    // the band every 20ms, the steps grow out to the edges
+    const TestAnalyzer::Grid grid(-120000, 2000);
+    assertEqual(grid.start(), -120000);
+    assertEqual(grid[TestAnalyzer::PEAK_BIN], 0);
+    assertEqual(grid.end(), 2000);
+    int step = TestAnalyzer::TEST_STEP_TIME;
+    for (uint8_t bin = TestAnalyzer::GRID_BEFORE; bin > 0; bin--)
+    {
+        int next = grid[bin] - grid[bin - 1];
+        assertMore(next, step);
+        step = next;
+    }
+    for (uint8_t bin = 0; bin < TestAnalyzer::MAX_RESULT; bin++)
+        assertEqual(grid.index(grid[bin]), (int)bin);
+    assertEqual(grid.index(-30), -1);
+
+    // a wider band, steps of 20ms from -400 to 200, out of reach is clamped
+    const TestAnalyzer::Grid wide(-120000, 2000, 400, 200);
+    for (int time = -400; time <= 200; time += TestAnalyzer::TEST_STEP_TIME)
+        assertEqual(wide.index(time), TestAnalyzer::PEAK_BIN + time / (int)TestAnalyzer::TEST_STEP_TIME);
+    assertMore(wide[TestAnalyzer::PEAK_BIN - 20] - wide[TestAnalyzer::PEAK_BIN - 21], (int)TestAnalyzer::TEST_STEP_TIME);
+    const TestAnalyzer::Grid clamped(-120000, 2000, 0, 100000);
+    assertEqual(clamped.index(-TestAnalyzer::BAND_MIN_BEFORE - (int)TestAnalyzer::TEST_STEP_TIME), -1);
+    assertEqual(clamped.index(TestAnalyzer::BAND_MAX_AFTER), TestAnalyzer::PEAK_BIN + TestAnalyzer::BAND_MAX_AFTER / (int)TestAnalyzer::TEST_STEP_TIME);
+
+    // a short test, steps of 20ms out of the band
+    const TestAnalyzer::Grid least(-300, 150);
+    assertEqual(least.start(), TestAnalyzer::GRID_MIN_START);
+    assertEqual(least.end(), TestAnalyzer::GRID_MIN_END);
+    for (uint8_t bin = 1; bin < TestAnalyzer::MAX_RESULT; bin++)
+        assertEqual(least[bin] - least[bin - 1], (int)TestAnalyzer::TEST_STEP_TIME);
+
+    // a 25s test with the peak at 12.5s, the grid from its first to its last sample
+    analyzer.clear();
+    analyzer.clearData();
+    analyzer.setStream("/data/test_grid.bin");
+    analyzer.trigger(0.0, 0);
+    for (int i = 0; i < 2000; i++)
+        assertTrue(analyzer.addSample(i * 0.001, gridCurve(i), i * 12500LL));
+    analyzer.endStream();
+    analyzer.addTest(0);
+    assertEqual(analyzer.getGrid().start(), -12500);
+    assertEqual(analyzer.getGrid().end(), 12487);
+
+    // the whole test from the log
+    assertEqual(analyzer.accumulated_data.size(), (uint32_t)TestAnalyzer::MAX_RESULT);
+    for (uint8_t bin = 0; bin < TestAnalyzer::MAX_RESULT; bin++)
+    {
+        const float i = 1000 + analyzer.getGrid()[bin] / 12.5f;
+        ResultBin *item = analyzer.getBin(bin);
+        assertEqual(item->time, analyzer.getGrid()[bin]);
+        assertNear(item->force, gridCurve(lroundf(i)), 0.03);
+        assertNear(item->distance, std::max(i, 0.0f) * 0.001f, 0.0001);
+    }
+    LittleFS.remove("/data/test_grid.bin");
+    analyzer.setStream("");
+
+    // a result file of the old grid, only the band: the new bins go in order
+    const TestAnalyzer::Grid first = analyzer.getGrid();
+    for (uint8_t bin = 0; bin < TestAnalyzer::MAX_RESULT; bin++)
+        if (bin < TestAnalyzer::GRID_BEFORE || bin >= TestAnalyzer::GRID_BEFORE + TestAnalyzer::BAND_BINS)
+            analyzer.accumulated_data.remove(analyzer.getPoint(first[bin]));
+    assertEqual(analyzer.accumulated_data.size(), (uint32_t)TestAnalyzer::BAND_BINS);
+    assertTrue(analyzer.getBin(TestAnalyzer::PEAK_BIN));
+    assertFalse(analyzer.getBin(0));
+    analyzer.addTest(1);
+    assertEqual(analyzer.accumulated_data.size(), (uint32_t)TestAnalyzer::MAX_RESULT);
+    for (uint8_t bin = 0; bin < TestAnalyzer::MAX_RESULT; bin++)
+        assertEqual(analyzer.accumulated_data[bin]->time, analyzer.getGrid()[bin]);
+    assertEqual(analyzer.getPoint(0)->count, (uint16_t)2);
+    assertEqual(analyzer.getPoint(-12500)->count, (uint16_t)1);
+
+    // a shorter run is added on the grid of the result
+    analyzer.clearData();
+    for (int i = 0; i < 400; i++)
+        assertTrue(analyzer.addSample(i * 0.001, gridCurve(i + 800), i * 12500LL));
+    analyzer.addTest(0);
+    assertEqual(analyzer.getGrid().start(), -12500);
+    assertEqual(analyzer.getGrid().end(), 12487);
+    assertEqual(analyzer.getPoint(-12500)->count, (uint16_t)2);
+}
+
+test(summaryTest)
+{
+    // two runs of a ramp to 20/22kg at 2mm, broken after it
+    DataArray<TestAnalyzer::MAX_RESULT, ResultBin> result;
+    float distance[TestAnalyzer::MAX_RESULT], force[TestAnalyzer::MAX_RESULT];
+    for (uint8_t k = 0; k < 2; k++)
+    {
+        for (uint8_t bin = 0; bin < TestAnalyzer::MAX_RESULT; bin++)
+        {
+            distance[bin] = bin * 0.1;
+            force[bin] = bin <= 20 ? (20 + 2 * k) * bin / 20.0 : bin == 21 ? 3 : 0;
+        }
+        TestAnalyzer::accumulate(result, TestAnalyzer::Grid(), distance, force);
+    }
+
+    HistoryItem item;
+    item.set("/result/r.json", "r", "", "", 5, 2);
+    item.summarize(result);
+    assertNear(item.peakForce, 21 * GRAVITY, 0.01);
+    assertNear(item.peakStress, 21 * GRAVITY / 2, 0.01);
+    assertNear(item.peakStd, sqrtf(2) * GRAVITY, 0.01);
+    // 3kg is over 10% of the peak, the break is the bin after it
+    assertNear(item.breakDistance, 2.1, 0.0001);
+    assertNear(item.energy, (21 * 2 / 2.0 + (21 + 3) / 2.0 * 0.1) * GRAVITY / 1000, 0.0001);
+
+    // saved with the history
+    JsonDocument doc;
+    JsonObject obj = doc.to<JsonObject>();
+    item.serializeItem(obj, false);
+    HistoryItem loaded;
+    assertTrue(loaded.deserializeItem(obj));
+    assertNear(loaded.energy, item.energy, 0.0001);
+    assertNear(loaded.breakDistance, 2.1, 0.001);
+}
+
+test(payloadTest)
+{
+    // a result of 10 noisy runs, what the file and a client get
+    DataArray<TestAnalyzer::MAX_RESULT, ResultBin> result;
+    float distance[TestAnalyzer::MAX_RESULT], force[TestAnalyzer::MAX_RESULT];
+    for (uint8_t k = 0; k < 10; k++)
+    {
+        for (uint8_t bin = 0; bin < TestAnalyzer::MAX_RESULT; bin++)
+        {
+            distance[bin] = bin * 0.137 + k * 0.0071;
+            force[bin] = bin * 0.731 + (k % 3) * 0.113;
+        }
+        TestAnalyzer::accumulate(result, TestAnalyzer::Grid(), distance, force);
+    }
+    for (ResultBin *item : result)
+        item->setBand(item->min, item->force, item->max, 10);
+
+    JsonDocument file, client;
+    JsonArray f = file.to<JsonArray>();
+    JsonArray c = client.to<JsonArray>();
+    result.serializeData(f);
+    result.serializeData(c, true);
+    const size_t fileSize = measureJson(file), clientSize = measureJson(client);
+    Serial.printf("result of %d bins: file %u bytes, client %u bytes\n",
+                  TestAnalyzer::MAX_RESULT, (unsigned)fileSize, (unsigned)clientSize);
+    // d, f, t, mi, ma, n and the band, ~100 bytes a bin.
+    // The file has the full mean, m2 and the runs of the band
+    assertLess(clientSize, (size_t)TestAnalyzer::MAX_RESULT * 110);
+    assertLess(fileSize, (size_t)TestAnalyzer::MAX_RESULT * 150);
+}
+
+// force (kg) of a specimen by its strain, breaks at 10.4%
+float strainCurve(float strain)
+{
+    return strain < 0.104 ? 200 * strain * (1 - 4 * strain) : 0.0;
+}
+
+test(strainTest)
+{
+    // two specimens of 10 and 20mm, the same material at different speeds
+    const float lengths[] = {10.0, 20.0};
+    const float step = 0.125 / (TestAnalyzer::MAX_RESULT - 1); // 12.5%
+    DataArray<TestAnalyzer::MAX_RESULT, ResultBin> result;
+    float distance[TestAnalyzer::MAX_RESULT], force[TestAnalyzer::MAX_RESULT];
+
+    for (uint8_t k = 0; k < 2; k++)
+    {
+        analyzer.clearData();
+        analyzer.setStream("/data/test_strain.bin");
+        analyzer.trigger(0.0, 0);
+        const float speed = (k + 1) * 0.003; // mm per sample
+        for (int i = 0; i * speed < lengths[k] * 0.11; i++)
+            assertTrue(analyzer.addSample(i * speed, strainCurve(i * speed / lengths[k]), i * 12500LL));
+        analyzer.endStream();
+
+        assertTrue(analyzer.resampleStrain(lengths[k], step, 5.0, distance, force));
+        TestAnalyzer::accumulate(result, TestAnalyzer::Grid::strain(), distance, force);
+    }
+    analyzer.setStream("");
+    LittleFS.remove("/data/test_strain.bin");
+
+    // the bins are numbered, none is at the time of the peak but the first
+    assertEqual(result[TestAnalyzer::PEAK_BIN]->time, (int)TestAnalyzer::PEAK_BIN);
+    assertEqual(TestAnalyzer::getPoint(result, 0), result[0]);
+
+    // the bins are the same strain for both, in mm of a 5mm result
+    assertNear(TestAnalyzer::strainStep(result, 5.0), step, 0.00001);
+    for (uint8_t bin = 0; bin < TestAnalyzer::MAX_RESULT; bin++)
+    {
+        ResultBin *item = TestAnalyzer::getBin(result, bin);
+        assertEqual(item->count, (uint16_t)2);
+        assertNear(item->distance, bin * step * 5.0, 0.0001);
+        assertNear(item->force, strainCurve(bin * step), 0.02);
+        assertNear(item->stddev(), 0.0, 0.02);
+    }
+    // after the end of the log, broken
+    assertEqual(TestAnalyzer::getBin(result, TestAnalyzer::MAX_RESULT - 1)->force, 0.0f);
+
+    // no log of the test
+    assertFalse(analyzer.resampleStrain(10.0, step, 5.0, distance, force));
+}
+
+// toe until 0.2mm, 2kg/mm until 10kg, hardening 0.1kg/mm, break at 10.2mm
+float yieldCurve(float x)
+{
+    if (x < 0.2f)
+        return 0;
+    if (x < 5.2f)
+        return 2.0f * (x - 0.2f);
+    return x <= 10.2f ? 10.0f + 0.1f * (x - 5.2f) : 0;
+}
+
+test(specimenTest)
+{
+    // a run without its specimen, the length comes with the result
+    const float LENGTH = 50, AREA = 10;
+    analyzer.clearData();
+    analyzer.setSpecimen(0, 1.0, 4.0);
+    analyzer.setStream("/data/test_specimen.bin");
+    analyzer.trigger(0.0, 0);
+    for (int i = 0; i <= 2100; i++)
+        assertTrue(analyzer.addSample(i * 0.005, yieldCurve(i * 0.005), i * 12500LL));
+    analyzer.endStream();
+
+    // no yield while it ran, the modulus is the same whatever the length
+    TestProperties live = analyzer.getProperties(LENGTH, AREA);
+    assertEqual(live.yieldForce, 0.0f);
+    TestProperties saved = analyzer.getProperties(LENGTH, AREA, true);
+    assertNear(saved.modulus, live.modulus, 0.1);
+    assertNear(saved.peakStress, live.peakStress, 0.001);
+    assertNear(saved.strain, 10.2f / LENGTH * 100, 0.01);
+    // 0.2% offset line: 2(x - 0.3) crosses 10 + 0.1(x - 5.2)
+    assertNear(saved.yieldDistance, 10.08f / 1.9f, 0.005);
+    assertNear(saved.yieldStress, saved.yieldForce / AREA, 0.001);
+
+    // the log moves to its result, over the one of the run before
+    LittleFS.open("/data/test_specimen_result.bin", FILE_WRITE).close();
+    assertTrue(analyzer.moveStream("/data/test_specimen_result.bin"));
+    assertFalse(LittleFS.exists("/data/test_specimen.bin"));
+    TestProperties moved = analyzer.getProperties(LENGTH, AREA, true);
+    assertNear(moved.yieldForce, saved.yieldForce, 0.0001);
+
+    // the same as the run with the length
+    analyzer.setStream("");
+    LittleFS.remove("/data/test_specimen_result.bin");
+    analyzer.clearData();
+    analyzer.setSpecimen(LENGTH, 1.0, 4.0);
+    for (int i = 0; i <= 2100; i++)
+        assertTrue(analyzer.addSample(i * 0.005, yieldCurve(i * 0.005), i * 12500LL));
+    TestProperties run = analyzer.getProperties(LENGTH, AREA, true);
+    assertNear(saved.yieldForce, run.yieldForce, 0.001);
+    assertNear(saved.energy, run.energy, 0.0001);
+}
+
 void setup()
 {
     delay(1000);
     Serial.begin(115200);
+    LittleFS.begin(true);
 }
 
 void loop()
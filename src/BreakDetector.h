@@ -0,0 +1,111 @@
+#ifndef BREAKDETECTOR_H
+#define BREAKDETECTOR_H
+
+#include <stdint.h>
+#include <atomic>
+
+/*
+ * Break of the specimen, checked on every sample in the sampler task.
+ *
+ * A break is a drop of dropPercent from the max of the last windowMs, once
+ * the force has passed minForce. A slow decline (yield, necking) is spread
+ * over more than the window and does not trip it, updateTest() still ends
+ * those tests below the stop force.
+ *
+ * The max of the window is a monotonic queue, O(1) amortized per sample and
+ * fixed memory. arm()/disarm() are called from loop(), update() only from the
+ * sampler task, the state is reset by the task when it sees a new arm().
+ */
+class BreakDetector
+{
+public:
+	// 400ms at 80hz
+	static const uint8_t MAX_WINDOW_SAMPLES = 32;
+
+	// forces in net counts
+	void arm(uint8_t drop_percent, uint32_t window_ms, int32_t min_force)
+	{
+		dropPercent = drop_percent;
+		windowUs = int64_t(window_ms) * 1000;
+		minForce = min_force;
+		tripped.store(false);
+		generation.fetch_add(1);
+		armed.store(true);
+	}
+	void disarm() { armed.store(false); }
+
+	// true only for the sample that trips the detector
+	bool update(int32_t counts, int64_t time)
+	{
+		if (!armed.load(std::memory_order_relaxed))
+			return false;
+
+		uint32_t g = generation.load();
+		if (g != seenGeneration)
+		{
+			seenGeneration = g;
+			head = count = 0;
+			ready = false;
+		}
+
+		// drop the old samples and the ones lower than the new one
+		while (count > 0 && time - times[head] > windowUs)
+			popFront();
+		while (count > 0 && values[back()] <= counts)
+			count--;
+		if (count == MAX_WINDOW_SAMPLES)
+			popFront();
+		times[at(count)] = time;
+		values[at(count)] = counts;
+		count++;
+
+		const int32_t max = values[head];
+		if (max >= minForce)
+			ready = true;
+
+		if (ready && int64_t(counts) * 100 <= int64_t(max) * (100 - dropPercent))
+		{
+			tripTime = time;
+			tripForce = max;
+			armed.store(false);
+			tripped.store(true);
+			return true;
+		}
+		return false;
+	}
+
+	bool isArmed() { return armed.load(); }
+	bool hasTripped() { return tripped.load(); }
+	// time (us) of the sample that tripped and the max before the drop
+	int64_t getTripTime() { return tripTime; }
+	int32_t getTripForce() { return tripForce; }
+
+private:
+	std::atomic<bool> armed{false};
+	std::atomic<bool> tripped{false};
+	std::atomic<uint32_t> generation{0};
+	uint32_t seenGeneration = 0;
+
+	uint8_t dropPercent = 30;
+	int64_t windowUs = 100000;
+	int32_t minForce = 0;
+	bool ready = false;
+	volatile int64_t tripTime = 0;
+	volatile int32_t tripForce = 0;
+
+	// monotonic queue of the window, decreasing values from head
+	int64_t times[MAX_WINDOW_SAMPLES];
+	int32_t values[MAX_WINDOW_SAMPLES];
+	uint8_t head = 0;
+	uint8_t count = 0;
+
+	uint8_t at(uint8_t i) { return (head + i) % MAX_WINDOW_SAMPLES; }
+	uint8_t back() { return at(count - 1); }
+	void popFront()
+	{
+		head = at(1);
+		count--;
+	}
+};
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef CALIBRATION_H
+#define CALIBRATION_H
+
+#include <stdint.h>
+#include <math.h>
+
+/*
+ * HX711 counts to force, in fixed point.
+ *
+ * The sample path (acquisition, trigger, rupture, windowing) works with net
+ * counts: raw - offset, with the sign of the load cell so that they grow with
+ * the force. They are converted to mg/kg only when a result is produced, so a
+ * new calibration factor can be applied again to the stored counts.
+ *
+ *   mg = (net * mgPerCount) >> 16   mgPerCount in Q16
+ */
+struct Calibration
+{
+	int32_t offset = 0;			  // raw counts at zero (tare)
+	float countsPerKg = 10000.0f; // |calibration factor|
+	int8_t sign = 1;			  // sign of the calibration factor
+	int64_t mgPerCount = 0;		  // Q16
+
+	Calibration() { set(0, countsPerKg); }
+
+	// factor = raw counts per kg, negative if the cell is mounted inverted
+	void set(int32_t offset, float factor)
+	{
+		this->offset = offset;
+		sign = factor < 0 ? -1 : 1;
+		countsPerKg = fabsf(factor);
+		mgPerCount = llroundf(1e6f * 65536.0f / countsPerKg);
+	}
+	void setOffset(int32_t offset) { this->offset = offset; }
+
+	// raw HX711 counts to net counts (0 at tare, positive under tension)
+	int32_t net(int32_t raw) const { return (raw - offset) * sign; }
+
+	int32_t toMg(int32_t counts) const { return (int32_t)((counts * mgPerCount) >> 16); }
+	float toKg(int32_t counts) const { return toMg(counts) / 1e6f; }
+	// kg to net counts, thresholds are converted once before the test
+	int32_t fromKg(float kg) const { return lroundf(kg * countsPerKg); }
+};
+
+#endif
@@ -0,0 +1,217 @@
+#ifndef MATERIALPROPERTIES_H
+#define MATERIALPROPERTIES_H
+
+#include "arduino.h"
+#include <DataTable.h>
+#include "Calibration.h"
+
+/*
+ * Properties of a test computed while the samples arrive, O(1) per sample,
+ * so the summary is ready at the end without keeping the curve.
+ *
+ *  - stiffness/modulus: least squares fit of force/distance with the samples
+ *    inside a force band (the linear part, above the toe)
+ *  - yield: first crossing of the curve with the fit moved 0.2% of the length
+ *  - peak force, elongation and energy (trapezoids) until the break, the last
+ *    sample over 10% of the peak
+ *
+ * The tracker works in net counts and um, TestProperties converts to N, MPa
+ * and J with the calibration, the length and the area of the specimen.
+ */
+
+static const float GRAVITY = 9.80665f; // N/kg
+
+struct TestProperties
+{
+	float peakForce = 0;	// N
+	float peakStress = 0;	// MPa
+	float peakDistance = 0; // mm
+	float stiffness = 0;	// N/mm, 0 if the band was not crossed
+	float modulus = 0;		// MPa
+	float yieldForce = 0;	// N, 0 if not found
+	float yieldStress = 0;	// MPa
+	float yieldDistance = 0; // mm
+	float elongation = 0;	// mm at break
+	float strain = 0;		// % at break
+	float energy = 0;		// J to break
+
+	void serialize(JsonObject &obj) const
+	{
+		obj["peak_f"] = round(peakForce * 100.0) / 100.0;
+		obj["peak_s"] = round(peakStress * 100.0) / 100.0;
+		obj["peak_d"] = round(peakDistance * 1000.0) / 1000.0;
+		obj["stiff"] = round(stiffness * 10.0) / 10.0;
+		obj["modulus"] = round(modulus * 10.0) / 10.0;
+		obj["yield_f"] = round(yieldForce * 100.0) / 100.0;
+		obj["yield_s"] = round(yieldStress * 100.0) / 100.0;
+		obj["yield_d"] = round(yieldDistance * 1000.0) / 1000.0;
+		obj["elong"] = round(elongation * 1000.0) / 1000.0;
+		obj["strain"] = round(strain * 100.0) / 100.0;
+		obj["energy"] = round(energy * 10000.0) / 10000.0;
+	}
+};
+
+class PropertyTracker
+{
+public:
+	// force band of the fit in net counts, yield offset in um (0.2% of the length),
+	// 0 if the length is not known, no yield
+	void begin(int32_t band_low, int32_t band_high, int32_t offset_um)
+	{
+		bandLow = band_low;
+		bandHigh = band_high;
+		offset = offset_um;
+		reset();
+	}
+
+	void reset()
+	{
+		samples = 0;
+		n = sx = sy = sxy = sxx = 0;
+		fitDone = false;
+		slope = lineStart = 0;
+		yieldFound = false;
+		yieldCounts = yieldX = 0;
+		peak = peakX = 0;
+		energy = breakEnergy = 0;
+		breakX = 0;
+	}
+
+	void add(int32_t x, int32_t counts)
+	{
+		if (samples++ > 0)
+			energy += int64_t(counts + prevCounts) * (x - prevX);
+
+		if (counts > peak)
+		{
+			peak = counts;
+			peakX = x;
+		}
+		// still loaded, the break is after this sample
+		if (int64_t(counts) * 10 >= peak)
+		{
+			breakX = x;
+			breakEnergy = energy;
+		}
+
+		if (!fitDone)
+			fit(x, counts);
+		else if (!yieldFound && offset > 0)
+			findYield(x, counts);
+
+		prevX = x;
+		prevCounts = counts;
+	}
+
+	// length (mm) and area (mm2) of the specimen for the stresses
+	TestProperties get(const Calibration &calibration, float length, float area)
+	{
+		TestProperties p;
+		const float newtons = GRAVITY / calibration.countsPerKg; // N per count
+
+		p.peakForce = calibration.toKg(peak) * GRAVITY;
+		p.peakDistance = peakX / 1000.0f;
+		p.elongation = breakX / 1000.0f;
+		// counts um / 2 => N mm / 1000 = J
+		p.energy = breakEnergy / 2.0f * newtons / 1000.0f / 1000.0f;
+
+		// a weak specimen that never left the band, only the stiffness
+		if (fitDone || computeFit())
+			p.stiffness = slope * newtons * 1000.0f;
+		if (yieldFound)
+		{
+			p.yieldForce = yieldCounts * newtons;
+			p.yieldDistance = yieldX / 1000.0f;
+		}
+		if (area > 0)
+		{
+			p.peakStress = p.peakForce / area;
+			p.yieldStress = p.yieldForce / area;
+			p.modulus = p.stiffness * length / area;
+		}
+		if (length > 0)
+			p.strain = p.elongation / length * 100.0f;
+		return p;
+	}
+
+	bool hasFit() { return fitDone; }
+	bool hasYield() { return yieldFound; }
+
+private:
+	int32_t bandLow = 0;
+	int32_t bandHigh = 0;
+	int32_t offset = 0;
+
+	uint32_t samples = 0;
+	int32_t prevX = 0;
+	int32_t prevCounts = 0;
+
+	// sums of the fit, x in um, y in counts
+	int64_t n = 0, sx = 0, sy = 0, sxy = 0, sxx = 0;
+	bool fitDone = false;
+	float slope = 0;	 // counts per um
+	float lineStart = 0; // um where the offset line is 0
+
+	bool yieldFound = false;
+	float yieldCounts = 0;
+	float yieldX = 0;
+	float prevDelta = 0;
+
+	int32_t peak = 0;
+	int32_t peakX = 0;
+	int64_t energy = 0; // counts um * 2
+	int64_t breakEnergy = 0;
+	int32_t breakX = 0;
+
+	void fit(int32_t x, int32_t y)
+	{
+		if (y >= bandLow && y <= bandHigh)
+		{
+			n++;
+			sx += x;
+			sy += y;
+			sxy += int64_t(x) * y;
+			sxx += int64_t(x) * x;
+			return;
+		}
+		// once over the band the fit is closed
+		if (y > bandHigh && computeFit())
+		{
+			fitDone = true;
+			prevDelta = y - slope * (x - lineStart);
+		}
+	}
+
+	bool computeFit()
+	{
+		if (n < 2)
+			return false;
+		double den = double(n) * sxx - double(sx) * sx;
+		if (den <= 0)
+			return false;
+		double k = (double(n) * sxy - double(sx) * sy) / den;
+		double b = (sy - k * sx) / n;
+		if (k <= 0)
+			return false;
+		slope = k;
+		// where the fit crosses 0 (toe) plus the offset
+		lineStart = -b / k + offset;
+		return true;
+	}
+
+	void findYield(int32_t x, int32_t y)
+	{
+		// the curve goes under the offset line
+		float delta = y - slope * (x - lineStart);
+		if (delta <= 0 && prevDelta > 0)
+		{
+			float t = prevDelta / (prevDelta - delta);
+			yieldCounts = prevCounts + t * (y - prevCounts);
+			yieldX = prevX + t * (x - prevX);
+			yieldFound = true;
+		}
+		prevDelta = delta;
+	}
+};
+
+#endif
@@ -0,0 +1,184 @@
+#ifndef OUTLIERCHECK_H
+#define OUTLIERCHECK_H
+
+#include "TestAnalyzer.h"
+#include <algorithm>
+
+/*
+ * Robust check of a new run against the runs already in a result, before
+ * add_avg folds it in (a slip, a specimen broken at the grip...).
+ *
+ * A score is a robust z, (x - median) / (1.4826 * MAD) of every bin over
+ * the runs of the result, |z| over ~3.5 is an outlier. Three scores:
+ *
+ *  - peak: force of the run at the peak bin
+ *  - displacement: distance of the run at the peak bin (rupture)
+ *  - shape: median |z| of the force over all the bins
+ *
+ * The runs come from the RunStore of the result, the last MAX_RUNS
+ * included (RunSet), O(bins * runs). The same runs give the P10/P50/P90
+ * band the result keeps in its bins (setBand). A result saved before its
+ * runs were kept only has that band: median and spread from it, for a
+ * normal distribution sigma = (P90 - P10) / 2.563, O(bins), and no
+ * displacement score.
+ */
+
+struct OutlierReport
+{
+	bool checked = false; // false if the result has less than MIN_RUNS
+	float peak = 0;		  // robust z of each score
+	float displacement = 0;
+	float shape = 0;
+	bool outlier = false;
+
+	String toString()
+	{
+		if (!checked)
+			return String("not enough runs to check");
+		char str[80];
+		snprintf(str, sizeof(str), "z peak %.1f, displacement %.1f, shape %.1f",
+				 peak, displacement, shape);
+		return String(str);
+	}
+};
+
+class OutlierCheck
+{
+public:
+	static const uint8_t BINS = TestAnalyzer::MAX_RESULT;
+	static const uint8_t MIN_RUNS = 3;
+	static const uint8_t MAX_RUNS = 32;
+
+	// the last MAX_RUNS runs of a result, the force of every bin and the
+	// distance at the peak bin. ~5KB, in the heap while it's used
+	struct RunSet
+	{
+		uint8_t runs = 0;
+		uint8_t next = 0;
+		float force[MAX_RUNS][BINS];
+		float distance[MAX_RUNS];
+
+		void add(const float distance[BINS], const float force[BINS])
+		{
+			memcpy(this->force[next], force, sizeof(this->force[next]));
+			this->distance[next] = distance[TestAnalyzer::PEAK_BIN];
+			next = (next + 1) % MAX_RUNS;
+			runs = std::min<uint8_t>(runs + 1, MAX_RUNS);
+		}
+
+		// the band of every bin of data from these runs, exact (sorted,
+		// linear between the ranks). data must have all the bins
+		void setBand(DataArray<BINS, ResultBin> &data)
+		{
+			if (runs == 0 || data.size() != BINS)
+				return;
+			float values[MAX_RUNS];
+			for (uint8_t bin = 0; bin < BINS; bin++)
+			{
+				for (uint8_t i = 0; i < runs; i++)
+					values[i] = force[i][bin];
+				std::sort(values, values + runs);
+				data[bin]->setBand(quantile(values, 0.1), quantile(values, 0.5), quantile(values, 0.9), runs);
+			}
+		}
+
+	private:
+		float quantile(const float *sorted, float q)
+		{
+			const float position = q * (runs - 1);
+			const uint8_t i = position;
+			if (i + 1 >= runs)
+				return sorted[runs - 1];
+			return sorted[i] + (sorted[i + 1] - sorted[i]) * (position - i);
+		}
+	};
+
+	// runs of the result from its store, the run its bins (mm, kg)
+	static OutlierReport check(RunSet &set, const float distance[BINS], const float force[BINS], float limit = 3.5)
+	{
+		OutlierReport report;
+		if (set.runs < MIN_RUNS)
+			return report;
+		report.checked = true;
+
+		const uint8_t peak_bin = TestAnalyzer::PEAK_BIN;
+		float values[MAX_RUNS];
+		for (uint8_t i = 0; i < set.runs; i++)
+			values[i] = set.force[i][peak_bin];
+		report.peak = score(force[peak_bin], values, set.runs);
+		memcpy(values, set.distance, set.runs * sizeof(float));
+		report.displacement = score(distance[peak_bin], values, set.runs);
+
+		float z[BINS];
+		for (uint8_t bin = 0; bin < BINS; bin++)
+		{
+			for (uint8_t i = 0; i < set.runs; i++)
+				values[i] = set.force[i][bin];
+			z[bin] = fabsf(score(force[bin], values, set.runs));
+		}
+		report.shape = median(z, BINS);
+
+		report.outlier = fabsf(report.peak) > limit ||
+						 fabsf(report.displacement) > limit ||
+						 report.shape > limit;
+		return report;
+	}
+
+	// data is the summary of the result, without a store of its runs
+	static OutlierReport check(DataArray<BINS, ResultBin> &data,
+							   const float distance[BINS], const float force[BINS], float limit = 3.5)
+	{
+		OutlierReport report;
+		const uint8_t peak_bin = TestAnalyzer::PEAK_BIN;
+		ResultBin *peak = TestAnalyzer::getBin(data, peak_bin);
+		if (!peak || peak->bandCount < MIN_RUNS)
+			return report;
+		report.checked = true;
+
+		report.peak = score(force[peak_bin], *peak);
+
+		float z[BINS];
+		uint8_t n = 0;
+		for (uint8_t bin = 0; bin < BINS; bin++)
+		{
+			ResultBin *item = TestAnalyzer::getBin(data, bin);
+			if (item && item->bandCount >= MIN_RUNS)
+				z[n++] = fabsf(score(force[bin], *item));
+		}
+		if (n > 0)
+			report.shape = median(z, n);
+
+		report.outlier = fabsf(report.peak) > limit ||
+						 fabsf(report.displacement) > limit ||
+						 report.shape > limit;
+		return report;
+	}
+
+private:
+	static float score(float x, ResultBin &band)
+	{
+		return score(x, band.p50, (band.p90 - band.p10) / 2.563f);
+	}
+	// values of the runs, reordered
+	static float score(float x, float *values, uint8_t n)
+	{
+		const float center = median(values, n);
+		for (uint8_t i = 0; i < n; i++)
+			values[i] = fabsf(values[i] - center);
+		return score(x, center, 1.4826f * median(values, n));
+	}
+	static float score(float x, float center, float sigma)
+	{
+		// identical runs, 2% of the median
+		sigma = std::max(sigma, std::max(fabsf(center) * 0.02f, 0.001f));
+		return (x - center) / sigma;
+	}
+	// upper median, reorders the values
+	static float median(float *values, uint8_t n)
+	{
+		std::nth_element(values, values + n / 2, values + n);
+		return values[n / 2];
+	}
+};
+
+#endif
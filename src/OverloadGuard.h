@@ -0,0 +1,86 @@
+#ifndef OVERLOADGUARD_H
+#define OVERLOADGUARD_H
+
+#include <stdint.h>
+#include <atomic>
+
+/*
+ * Hard limit of the load cell, checked on every sample in the sampler task
+ * whatever the machine is doing (test, move, homing).
+ *
+ * check() tells when the motor must be stopped: at the sample that crosses
+ * the limit (a trip) and, while the force stays over it, every time the motor
+ * moves again in the direction of the trip. Moving in the other direction
+ * unloads the cell and is allowed. A trip at rest takes the direction of
+ * the last move, with no move seen both directions are stopped. Below
+ * RELEASE_PERCENT of the limit the guard is armed again.
+ *
+ * setLimit() is called from loop(), check() only from the sampler task,
+ * the counters are read by loop() to report them.
+ */
+class OverloadGuard
+{
+public:
+	static const uint8_t RELEASE_PERCENT = 90;
+
+	// net counts, 0 disables the guard
+	void setLimit(int32_t counts) { limit.store(counts); }
+	int32_t getLimit() { return limit.load(); }
+
+	// direction of the motor (1, -1, 0), true if it must be stopped
+	bool check(int32_t counts, int8_t direction)
+	{
+		const int32_t max = limit.load(std::memory_order_relaxed);
+		if (max <= 0)
+			return false;
+
+		if (counts > peak.load(std::memory_order_relaxed))
+			peak.store(counts, std::memory_order_relaxed);
+		if (direction != 0)
+			lastDirection = direction;
+
+		if (!tripped)
+		{
+			if (counts <= max)
+				return false;
+			tripped = true;
+			// at rest the last move loaded the cell
+			tripDirection = lastDirection;
+			trips.fetch_add(1);
+			return true;
+		}
+
+		if (int64_t(counts) * 100 < int64_t(max) * RELEASE_PERCENT)
+		{
+			tripped = false;
+			return false;
+		}
+		// still overloaded, only the unloading direction is free, none if unknown
+		if (direction != 0 && (tripDirection == 0 || direction == tripDirection))
+		{
+			blocked.fetch_add(1);
+			return true;
+		}
+		return false;
+	}
+
+	// times the limit was crossed, and the stops while it was still over it
+	uint32_t getTrips() { return trips.load(); }
+	uint32_t getBlocked() { return blocked.load(); }
+	// max force seen (net counts) since resetPeak()
+	int32_t getPeak() { return peak.load(); }
+	void resetPeak() { peak.store(0); }
+
+private:
+	std::atomic<int32_t> limit{0};
+	std::atomic<uint32_t> trips{0};
+	std::atomic<uint32_t> blocked{0};
+	std::atomic<int32_t> peak{0};
+
+	// only used by the sampler task
+	bool tripped = false;
+	int8_t tripDirection = 0;
+	int8_t lastDirection = 0;
+};
+
+#endif
@@ -0,0 +1,173 @@
+#ifndef QUANTILE_H
+#define QUANTILE_H
+
+#include <stdint.h>
+#include <math.h>
+
+/*
+ * Streaming estimate of a quantile with the P² algorithm (Jain & Chlamtac),
+ * 5 markers whatever the number of values added.
+ *
+ * The markers are the min, the max, the quantile and two halfway between.
+ * Every value moves the positions of the markers over it, the inner ones are
+ * then adjusted towards their ideal position with a parabola through their
+ * neighbours (linear if the parabola breaks the order). Until 5 values the
+ * markers are the sorted values and the quantile is exact.
+ *
+ * The state is 5 heights and 3 positions (the ends are 0 and count - 1).
+ * Results were saved with it, now it only gives their band when they are
+ * loaded until their runs are kept (ResultBin)
+ */
+class P2Quantile
+{
+public:
+	static const uint8_t MARKERS = 5;
+	// count, heights and inner positions
+	static const uint8_t STATE_SIZE = 1 + MARKERS + MARKERS - 2;
+
+	// p in 0..1
+	explicit P2Quantile(float p = 0.5) : p(p) {}
+
+	void reset()
+	{
+		count = 0;
+		for (uint8_t i = 0; i < MARKERS; i++)
+		{
+			heights[i] = 0;
+			positions[i] = i;
+		}
+	}
+
+	void add(float x)
+	{
+		if (count < MARKERS)
+		{
+			// insertion in the sorted start
+			uint8_t i = count++;
+			for (; i > 0 && heights[i - 1] > x; i--)
+				heights[i] = heights[i - 1];
+			heights[i] = x;
+			return;
+		}
+
+		// cell of x, the ends follow the min and max
+		uint8_t k;
+		if (x < heights[0])
+		{
+			heights[0] = x;
+			k = 0;
+		}
+		else if (x >= heights[MARKERS - 1])
+		{
+			heights[MARKERS - 1] = x;
+			k = MARKERS - 2;
+		}
+		else
+		{
+			k = 0;
+			while (x >= heights[k + 1])
+				k++;
+		}
+		for (uint8_t i = k + 1; i < MARKERS; i++)
+			positions[i]++;
+		count++;
+
+		for (uint8_t i = 1; i < MARKERS - 1; i++)
+		{
+			const float d = desired(i) - positions[i];
+			const int32_t right = int32_t(positions[i + 1]) - positions[i];
+			const int32_t left = int32_t(positions[i - 1]) - positions[i];
+			if ((d >= 1 && right > 1) || (d <= -1 && left < -1))
+			{
+				const int8_t s = d > 0 ? 1 : -1;
+				float h = parabolic(i, s);
+				if (h <= heights[i - 1] || h >= heights[i + 1])
+					h = linear(i, s);
+				heights[i] = h;
+				positions[i] += s;
+			}
+		}
+	}
+
+	// estimate of the quantile, 0 without values
+	float get()
+	{
+		if (count == 0)
+			return 0;
+		if (count <= MARKERS)
+		{
+			// nearest rank over the sorted values
+			uint8_t i = lroundf(p * (count - 1));
+			return heights[i];
+		}
+		return heights[2];
+	}
+
+	uint16_t getCount() { return count; }
+	float getP() { return p; }
+
+	// [count, heights..., inner positions...]
+	void getState(float state[STATE_SIZE])
+	{
+		state[0] = count;
+		for (uint8_t i = 0; i < MARKERS; i++)
+			state[1 + i] = heights[i];
+		for (uint8_t i = 1; i < MARKERS - 1; i++)
+			state[MARKERS + i] = positions[i];
+	}
+	// false if the state is not valid, the estimator is reset
+	bool setState(const float state[STATE_SIZE])
+	{
+		reset();
+		if (state[0] < 0 || state[0] > UINT16_MAX)
+			return false;
+		count = state[0];
+		for (uint8_t i = 0; i < MARKERS; i++)
+			heights[i] = state[1 + i];
+		if (count < MARKERS)
+			return true;
+		positions[MARKERS - 1] = count - 1;
+		for (uint8_t i = 1; i < MARKERS - 1; i++)
+			positions[i] = state[MARKERS + i];
+		for (uint8_t i = 1; i < MARKERS; i++)
+		{
+			if (positions[i] <= positions[i - 1] || heights[i] < heights[i - 1])
+			{
+				reset();
+				return false;
+			}
+		}
+		return true;
+	}
+
+private:
+	float p;
+	uint16_t count = 0;
+	float heights[MARKERS] = {0, 0, 0, 0, 0};
+	// 0 based, the ends are 0 and count - 1
+	uint16_t positions[MARKERS] = {0, 1, 2, 3, 4};
+
+	float desired(uint8_t i)
+	{
+		static const float fraction[MARKERS] = {0, 0.5, 1, 1.5, 2};
+		// 0, p/2, p, (1+p)/2, 1 of the last position
+		float f = i <= 2 ? fraction[i] * p : p + (fraction[i] - 1) * (1 - p);
+		return f * (count - 1);
+	}
+
+	float parabolic(uint8_t i, int8_t s)
+	{
+		const float n0 = positions[i - 1], n1 = positions[i], n2 = positions[i + 1];
+		const float q0 = heights[i - 1], q1 = heights[i], q2 = heights[i + 1];
+		return q1 + s / (n2 - n0) *
+						((n1 - n0 + s) * (q2 - q1) / (n2 - n1) +
+						 (n2 - n1 - s) * (q1 - q0) / (n1 - n0));
+	}
+
+	float linear(uint8_t i, int8_t s)
+	{
+		return heights[i] + s * (heights[i + s] - heights[i]) / (float(positions[i + s]) - positions[i]);
+	}
+};
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+
+#include <stdint.h>
+
+/*
+ * Linear resampling of a curve sorted by time on a grid of targets.
+ *
+ * The targets must come in ascending order, so the samples are walked only
+ * once (merge of the two sorted sequences): a whole grid costs
+ * O(samples + targets) instead of a search over the samples per target.
+ *
+ * Source is any column store with size() and time(i), like SampleBuffer.
+ * seek() only finds the two neighbours of a target, the caller interpolates
+ * the columns it needs with them:
+ *
+ *   Resampler<SampleBuffer<N>> walk(buffer);
+ *   for (t = from; t <= to; t += step)
+ *       if (walk.seek(t))
+ *           d = walk.interpolate(buffer.distance(walk.prev()), buffer.distance(walk.next()));
+ *
+ * Before the first sample and after the last one the two samples of the end
+ * are used, the curve is extrapolated.
+ */
+template <class Source>
+class Resampler
+{
+public:
+	Resampler(Source &source) : source(source) {}
+
+	// false if the source has less than 2 samples
+	bool seek(int64_t target)
+	{
+		const uint32_t size = source.size();
+		if (size < 2)
+			return false;
+
+		// first sample after target, it only moves forward
+		while (index < size && source.time(index) <= target)
+			index++;
+
+		if (index == 0)
+			prevIndex = 0;
+		else if (index == size)
+			prevIndex = size - 2;
+		else
+			prevIndex = index - 1;
+
+		const int64_t t0 = source.time(prevIndex);
+		span = source.time(prevIndex + 1) - t0;
+		offset = target - t0;
+		return true;
+	}
+
+	uint32_t prev() { return prevIndex; }
+	uint32_t next() { return prevIndex + 1; }
+
+	float interpolate(float a, float b)
+	{
+		if (span == 0)
+			return a;
+		float slope = (b - a) / float(span);
+		return a + slope * float(offset);
+	}
+
+	// integer columns (counts), rounded
+	int32_t interpolate(int32_t a, int32_t b)
+	{
+		if (span == 0)
+			return a;
+		int64_t delta = int64_t(b - a) * offset;
+		delta += (delta < 0 ? -span : span) / 2;
+		return a + delta / span;
+	}
+
+	// back to the first sample, for a new grid
+	void rewind() { index = 0; }
+
+private:
+	Source &source;
+	uint32_t index = 0;
+	uint32_t prevIndex = 0;
+	int64_t span = 1;
+	int64_t offset = 0;
+};
+
+#endif
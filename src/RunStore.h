@@ -0,0 +1,176 @@
+#ifndef RUNSTORE_H
+#define RUNSTORE_H
+
+#include "Arduino.h"
+#include <LittleFS.h>
+
+/*
+ * Every run of a result, next to its JSON summary, so the average can be
+ * recomputed without a run or with it again.
+ *
+ * file = RunStoreHeader + int32_t times[bins] + RunRecord * n
+ *
+ * Append only and fixed size records: a new run is one write at the end,
+ * excluding a run rewrites only its flags byte and a recompute reads the
+ * file once, ~820 bytes per run. Little endian, as written by the ESP32.
+ * The times of the bins of the result (ms from the peak, or the bin by
+ * strain) are the grid its runs are recomputed on.
+ *
+ * Results created before the store keep their old runs only in the summary,
+ * the header counts them (legacy) and they can't be recomputed.
+ */
+
+// 2: piecewise grid, see TestAnalyzer::Grid
+// 3: the edges of the grid of the result in the header
+// 4: the times of every bin after the header, the band of the grid is configurable
+static const uint16_t RUN_STORE_VERSION = 4;
+
+struct RunStoreHeader
+{
+	char magic[4] = {'P', 'T', 'R', 'N'};
+	uint16_t version = RUN_STORE_VERSION;
+	uint16_t bins = 0;
+	uint16_t legacy = 0; // runs in the summary that are not in the file
+	uint16_t reserved = 0;
+};
+
+static_assert(sizeof(RunStoreHeader) == 12, "RunStoreHeader layout");
+
+template <uint8_t BINS>
+struct RunRecord
+{
+	static const uint8_t EXCLUDED = 1;
+
+	uint8_t flags = 0;
+	uint8_t filter = 0; // StreamFilter::Type of the test
+	uint16_t reserved = 0;
+	float length = 0; // mm
+	float area = 0;	  // mm2
+	float speed = 0;  // mm/s
+	float factor = 0; // calibration, counts per kg
+	float distance[BINS];
+	float force[BINS]; // kg
+
+	bool isExcluded() { return flags & EXCLUDED; }
+};
+
+template <uint8_t BINS>
+class RunStore
+{
+public:
+	typedef RunRecord<BINS> Record;
+
+	// new store of a result, the times of its bins and legacy runs already in its summary
+	bool create(const char *path, const int32_t times[BINS], uint16_t legacy = 0)
+	{
+		File file = LittleFS.open(path, FILE_WRITE);
+		if (!file)
+		{
+			Serial.printf("RunStore - failed to open %s\n", path);
+			return false;
+		}
+		RunStoreHeader header;
+		header.bins = BINS;
+		header.legacy = legacy;
+		bool ok = file.write((const uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+				  file.write((const uint8_t *)times, TIMES_SIZE) == TIMES_SIZE;
+		file.close();
+		return ok;
+	}
+
+	bool append(const char *path, const Record &record)
+	{
+		File file = LittleFS.open(path, FILE_APPEND);
+		if (!file)
+			return false;
+		bool ok = file.write((const uint8_t *)&record, sizeof(record)) == sizeof(record);
+		file.close();
+		if (!ok)
+			Serial.println("RunStore - write failed, flash full?");
+		return ok;
+	}
+
+	// only the flags of the run are written
+	bool setExcluded(const char *path, uint16_t index, bool excluded)
+	{
+		RunStoreHeader header;
+		File file = LittleFS.open(path, "r+");
+		if (!readHeader(file, header) || index >= runs(file))
+		{
+			file.close();
+			return false;
+		}
+		uint8_t flags = 0;
+		const uint32_t pos = RECORDS_START + index * sizeof(Record);
+		bool ok = file.seek(pos) && file.read(&flags, 1) == 1;
+		if (ok)
+		{
+			flags = excluded ? flags | Record::EXCLUDED : flags & ~Record::EXCLUDED;
+			ok = file.seek(pos) && file.write(&flags, 1) == 1;
+		}
+		file.close();
+		return ok;
+	}
+
+	// header of the store, false if there is no valid store
+	bool getHeader(const char *path, RunStoreHeader &header)
+	{
+		File file = LittleFS.open(path, FILE_READ);
+		bool ok = readHeader(file, header);
+		file.close();
+		return ok;
+	}
+
+	// the times of the bins of the result
+	bool getTimes(const char *path, int32_t times[BINS])
+	{
+		RunStoreHeader header;
+		File file = LittleFS.open(path, FILE_READ);
+		bool ok = readHeader(file, header) && file.read((uint8_t *)times, TIMES_SIZE) == TIMES_SIZE;
+		file.close();
+		return ok;
+	}
+
+	// one pass over the runs, callback(index, record), the number of runs
+	template <class Callback>
+	int32_t forEach(const char *path, Callback callback)
+	{
+		RunStoreHeader header;
+		File file = LittleFS.open(path, FILE_READ);
+		if (!readHeader(file, header))
+		{
+			file.close();
+			return -1;
+		}
+		const uint16_t total = runs(file);
+		file.seek(RECORDS_START);
+		Record record;
+		uint16_t i = 0;
+		for (; i < total; i++)
+		{
+			if (file.read((uint8_t *)&record, sizeof(record)) != sizeof(record))
+				break;
+			callback(i, record);
+		}
+		file.close();
+		return i;
+	}
+
+private:
+	static const uint32_t TIMES_SIZE = BINS * sizeof(int32_t);
+	static const uint32_t RECORDS_START = sizeof(RunStoreHeader) + TIMES_SIZE;
+
+	bool readHeader(File &file, RunStoreHeader &header)
+	{
+		return file && file.read((uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+			   memcmp(header.magic, "PTRN", 4) == 0 && header.version == RUN_STORE_VERSION &&
+			   header.bins == BINS;
+	}
+
+	uint16_t runs(File &file)
+	{
+		return file.size() < RECORDS_START ? 0 : (file.size() - RECORDS_START) / sizeof(Record);
+	}
+};
+
+#endif
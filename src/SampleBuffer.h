@@ -0,0 +1,131 @@
+#ifndef SAMPLEBUFFER_H
+#define SAMPLEBUFFER_H
+
+#include <stdint.h>
+#include <math.h>
+#include <algorithm>
+
+/*
+ * Raw samples of a test stored by columns (struct of arrays).
+ *
+ * A SensorItem per sample costs 40 bytes plus a pointer in the DataArray,
+ * here a sample is 3 int32 = 12 bytes, a scan over one column (max force)
+ * reads contiguous memory and a search by time is a binary search, O(log n).
+ *
+ *   time     : us from origin, origin moves forward on long tests (rebase)
+ *   distance : nm  (int32, +-2m)
+ *   force    : net HX711 counts (see Calibration.h), converted to kg by the
+ *              analyzer only when a result is produced
+ *
+ * Works as a ring, a push on a full buffer overwrites the oldest sample.
+ * Index 0 is the oldest sample, the samples must be pushed sorted by time.
+ */
+template <uint32_t N>
+class SampleBuffer
+{
+public:
+	static constexpr float DISTANCE_SCALE = 1e6f; // nm per mm
+
+	static const uint32_t maxSize = N;
+
+	// returns true if the oldest sample was overwritten
+	bool push(int64_t timestamp, float distance, int32_t counts)
+	{
+		if (count == 0)
+			origin = timestamp;
+		else if (timestamp - origin > REBASE_LIMIT)
+			rebase(timestamp - origin - REBASE_LIMIT / 2);
+
+		uint32_t i = at(count);
+		times[i] = timestamp - origin;
+		distances[i] = lroundf(distance * DISTANCE_SCALE);
+		forces[i] = counts;
+
+		if (count < N)
+		{
+			count++;
+			return false;
+		}
+		head = at(1);
+		return true;
+	}
+
+	int64_t time(uint32_t index) { return origin + times[at(index)]; }
+	float distance(uint32_t index) { return distances[at(index)] / DISTANCE_SCALE; }
+	int32_t force(uint32_t index) { return forces[at(index)]; }
+
+	// index of the first sample after timestamp, size() if none
+	uint32_t upperBound(int64_t timestamp)
+	{
+		int64_t rel = timestamp - origin;
+		if (rel >= INT32_MAX)
+			return count;
+		if (rel < INT32_MIN)
+			return 0;
+
+		// binary search, the times are sorted from the oldest (index 0)
+		const int32_t t = rel;
+		uint32_t lo = 0, hi = count;
+		while (lo < hi)
+		{
+			const uint32_t mid = (lo + hi) / 2;
+			if (times[at(mid)] > t)
+				hi = mid;
+			else
+				lo = mid + 1;
+		}
+		return lo;
+	}
+
+	// index of the max force, first one if repeated
+	uint32_t maxForce()
+	{
+		uint32_t best = 0;
+		int32_t max = INT32_MIN;
+		for (uint32_t k = 0; k < count; k++)
+		{
+			int32_t f = forces[at(k)];
+			if (f > max)
+			{
+				max = f;
+				best = k;
+			}
+		}
+		return best;
+	}
+
+	uint32_t size() { return count; }
+	bool isFull() { return count == N; }
+	void clear()
+	{
+		head = 0;
+		count = 0;
+		origin = 0;
+	}
+
+private:
+	// rebase before the us offset reaches int32 (~35 min)
+	static const int64_t REBASE_LIMIT = 1LL << 30;
+
+	int32_t times[N];
+	int32_t distances[N];
+	int32_t forces[N];
+	int64_t origin = 0;
+	uint32_t head = 0;
+	uint32_t count = 0;
+
+	uint32_t at(uint32_t index)
+	{
+		uint32_t i = head + index;
+		return i < N ? i : i - N;
+	}
+
+	void rebase(int64_t delta)
+	{
+		origin += delta;
+		for (uint32_t k = 0; k < count; k++)
+			times[at(k)] -= delta;
+	}
+};
+
+#endif
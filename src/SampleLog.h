@@ -0,0 +1,202 @@
+#ifndef SAMPLELOG_H
+#define SAMPLELOG_H
+
+#include "Arduino.h"
+#include <LittleFS.h>
+#include "Calibration.h"
+
+/*
+ * Binary capture of a test on LittleFS, so the length of a test is limited
+ * by the flash and not by the RAM.
+ *
+ * file = SampleLogHeader + SampleBlock * n
+ *
+ * Every block has the same size on flash (the last one may be partially
+ * filled, see count), so block i starts at sizeof(header) + i * sizeof(block)
+ * and a time can be found with a binary search over the blocks.
+ * Little endian, as written by the ESP32. docs/replay.py and
+ * mytests/native/replay.cpp ([env:replay]) read it on a PC.
+ */
+
+// 2: force in net counts + calibration in the header
+static const uint16_t SAMPLE_LOG_VERSION = 2;
+
+struct SampleLogHeader
+{
+	char magic[4] = {'P', 'T', 'L', 'G'};
+	uint16_t version = SAMPLE_LOG_VERSION;
+	uint16_t blockSamples = 0;
+	uint32_t sampleRate = 0;
+	int32_t offset = 0;	  // raw counts at the tare
+	int64_t zeroTime = 0; // esp_timer time (us) of the trigger
+	float factor = 0;	  // calibration factor (raw counts per kg) of the test
+	uint32_t reserved = 0;
+};
+
+struct LogSample
+{
+	int32_t time;	// us from block baseTime
+	float distance; // mm from the trigger position
+	int32_t force;	// net counts, header factor to kg
+};
+
+static const uint16_t LOG_BLOCK_SAMPLES = 64; // 0.8s at 80hz
+
+struct SampleBlock
+{
+	uint32_t index = 0;
+	uint32_t count = 0;
+	int64_t baseTime = 0; // us from the trigger
+	LogSample samples[LOG_BLOCK_SAMPLES];
+
+	int64_t timeAt(uint32_t i) { return baseTime + samples[i].time; }
+};
+
+static_assert(sizeof(SampleLogHeader) == 32, "SampleLogHeader layout");
+static_assert(sizeof(SampleBlock) == 16 + LOG_BLOCK_SAMPLES * 12, "SampleBlock layout");
+
+// writes the samples of a running test in fixed size blocks
+class SampleLog
+{
+public:
+	bool begin(const char *path, uint32_t sample_rate, int64_t zero_time, const Calibration &calibration)
+	{
+		end();
+		file = LittleFS.open(path, FILE_WRITE);
+		if (!file)
+		{
+			Serial.printf("SampleLog - failed to open %s\n", path);
+			return false;
+		}
+
+		SampleLogHeader header;
+		header.blockSamples = LOG_BLOCK_SAMPLES;
+		header.sampleRate = sample_rate;
+		header.zeroTime = zero_time;
+		header.offset = calibration.offset;
+		header.factor = calibration.countsPerKg * calibration.sign;
+
+		block = SampleBlock();
+		total = 0;
+		failed = file.write((const uint8_t *)&header, sizeof(header)) != sizeof(header);
+		return !failed;
+	}
+
+	// time in us from the trigger, false if the flash is full
+	bool add(int64_t time, float distance, int32_t force)
+	{
+		if (!file || failed)
+			return false;
+
+		if (block.count == 0)
+			block.baseTime = time;
+
+		LogSample &s = block.samples[block.count++];
+		s.time = time - block.baseTime;
+		s.distance = distance;
+		s.force = force;
+		total++;
+
+		if (block.count == LOG_BLOCK_SAMPLES)
+			return writeBlock();
+		return true;
+	}
+
+	// writes the last partial block and closes the file
+	bool end()
+	{
+		if (!file)
+			return false;
+		bool ok = true;
+		if (block.count > 0)
+			ok = writeBlock();
+		file.close();
+		Serial.printf("SampleLog - %d samples saved\n", total);
+		return ok && !failed;
+	}
+
+	bool isOpen() { return (bool)file; }
+	uint32_t size() { return total; }
+
+private:
+	File file;
+	SampleBlock block;
+	uint32_t total = 0;
+	bool failed = false;
+
+	bool writeBlock()
+	{
+		if (file.write((const uint8_t *)&block, sizeof(block)) != sizeof(block))
+		{
+			Serial.println("SampleLog - write failed, flash full?");
+			failed = true;
+			return false;
+		}
+		block.index++;
+		block.count = 0;
+		return true;
+	}
+};
+
+// reads back a capture written by SampleLog
+class SampleLogReader
+{
+public:
+	bool open(const char *path)
+	{
+		close();
+		file = LittleFS.open(path, FILE_READ);
+		if (!file || file.read((uint8_t *)&header, sizeof(header)) != sizeof(header) ||
+			memcmp(header.magic, "PTLG", 4) != 0 || header.version != SAMPLE_LOG_VERSION ||
+			header.blockSamples != LOG_BLOCK_SAMPLES)
+		{
+			Serial.printf("SampleLog - %s not valid\n", path);
+			close();
+			return false;
+		}
+		blocks = (file.size() - sizeof(header)) / sizeof(SampleBlock);
+		return true;
+	}
+
+	void close()
+	{
+		if (file)
+			file.close();
+		blocks = 0;
+	}
+
+	uint32_t getBlocks() { return blocks; }
+	const SampleLogHeader &getHeader() { return header; }
+
+	bool readBlock(uint32_t index, SampleBlock &block)
+	{
+		if (index >= blocks ||
+			!file.seek(sizeof(header) + index * sizeof(SampleBlock)) ||
+			file.read((uint8_t *)&block, sizeof(block)) != sizeof(block))
+			return false;
+		return block.count <= LOG_BLOCK_SAMPLES;
+	}
+
+	// last block starting at or before time, binary search over the blocks
+	uint32_t findBlock(int64_t time)
+	{
+		SampleBlock block;
+		uint32_t lo = 0, hi = blocks;
+		while (hi - lo > 1)
+		{
+			uint32_t mid = (lo + hi) / 2;
+			if (readBlock(mid, block) && block.baseTime <= time)
+				lo = mid;
+			else
+				hi = mid;
+		}
+		return lo;
+	}
+
+private:
+	File file;
+	SampleLogHeader header;
+	uint32_t blocks = 0;
+};
+
+#endif
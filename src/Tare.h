@@ -0,0 +1,135 @@
+#ifndef TARE_H
+#define TARE_H
+
+#include <stdint.h>
+
+/*
+ * Zero of the load cell without blocking loop().
+ *
+ * Tare averages the next raw samples of the acquisition stream, it is fed
+ * by readSensors() and finishes when enough samples arrived (or times out if
+ * the HX711 stops). BaselineTracker keeps an up-to-date zero while the machine
+ * is idle, so a test can use it and start with no tare at all.
+ */
+
+class Tare
+{
+public:
+	enum State : uint8_t
+	{
+		IDLE = 0,
+		RUNNING,
+		DONE,
+		FAILED
+	};
+
+	// timeout in ms, a sample every 12.5ms at 80hz
+	void start(uint8_t samples, uint32_t now)
+	{
+		this->samples = samples > 0 ? samples : 1;
+		count = 0;
+		sum = 0;
+		started = now;
+		timeout = 200 * this->samples;
+		state = RUNNING;
+	}
+
+	// true when this sample completes the tare
+	bool add(int32_t raw)
+	{
+		if (state != RUNNING)
+			return false;
+		sum += raw;
+		if (++count < samples)
+			return false;
+		state = DONE;
+		return true;
+	}
+
+	// checks the timeout, true if the tare has just failed
+	bool update(uint32_t now)
+	{
+		if (state == RUNNING && now - started > timeout)
+		{
+			state = FAILED;
+			return true;
+		}
+		return false;
+	}
+
+	bool isRunning() { return state == RUNNING; }
+	State getState() { return state; }
+	int32_t getOffset() { return count ? sum / count : 0; }
+	void clear() { state = IDLE; }
+
+private:
+	State state = IDLE;
+	uint8_t samples = 1;
+	uint8_t count = 0;
+	int64_t sum = 0;
+	uint32_t started = 0;
+	uint32_t timeout = 0;
+};
+
+// zero tracked in blocks of samples, only the stable blocks move it
+class BaselineTracker
+{
+public:
+	static const uint8_t BLOCK_SAMPLES = 32; // 0.4s at 80hz
+
+	// max spread (counts) of a block to be taken as no load change
+	void setBand(int32_t band) { this->band = band; }
+
+	void add(int32_t raw, uint32_t now)
+	{
+		if (count == 0)
+			min = max = raw;
+		else if (raw < min)
+			min = raw;
+		else if (raw > max)
+			max = raw;
+		sum += raw;
+
+		if (++count < BLOCK_SAMPLES)
+			return;
+
+		if (max - min <= band)
+		{
+			int32_t mean = sum / BLOCK_SAMPLES;
+			// a new load at rest becomes the zero at once, small drifts are smoothed
+			if (!valid || mean - baseline > band || baseline - mean > band)
+				baseline = mean;
+			else
+				baseline += (mean - baseline) / 4;
+			valid = true;
+			updated = now;
+		}
+		count = 0;
+		sum = 0;
+	}
+
+	// the zero is valid and no older than max_age ms
+	bool isFresh(uint32_t now, uint32_t max_age) { return valid && now - updated <= max_age; }
+	int32_t getOffset() { return baseline; }
+
+	// the load may change (motor running, test, tare), the block starts again
+	void restart() { count = 0; sum = 0; }
+	void reset()
+	{
+		restart();
+		valid = false;
+	}
+
+private:
+	int32_t band = 1000;
+	int32_t baseline = 0;
+	bool valid = false;
+	uint32_t updated = 0;
+
+	uint8_t count = 0;
+	int64_t sum = 0;
+	int32_t min = 0;
+	int32_t max = 0;
+};
+
+#endif
@@ -2,195 +2,705 @@
 #define TESTANALYZER_H
 
 #include "data.h"
+#include "SampleLog.h"
+#include "SampleBuffer.h"
+#include "Resampler.h"
+#include "MaterialProperties.h"
+#include <algorithm>
 
 class TestAnalyzer 
 {
 private:
    
 // test const
-static const uint TEST_MAX_TIME = 20000;
+// only the samples around the peak are kept in RAM, the whole test goes
+// to the SampleLog file
 static const int TEST_START_TIME = -200;
 static const int TEST_END_TIME = 100;
+// samples kept before the trigger, the toe of the curve
+static const uint PRE_TRIGGER_TIME = 2000;
 
 public:
 
 static const uint TEST_STEP_TIME = 20; // 50hz
+// HX711 output rate, every conversion is captured by LoadCellSampler
+static const uint SAMPLE_RATE = 80;
 
-static const uint8_t MAX_RESULT = ((TEST_END_TIME - TEST_START_TIME) / TEST_STEP_TIME) + 1;
-DataArray<MAX_RESULT, SensorItem> accumulated_data;
+// the stored grid is piecewise: steps of TEST_STEP_TIME in a band around
+// the peak and steps growing geometrically out to the start and the end of
+// the test, see Grid. The band is configurable (setBand), at least the
+// window of the peak TEST_START_TIME..TEST_END_TIME
+static const uint8_t MAX_RESULT = 100;
+// bin of the peak (time 0), the same whatever the band and the edges
+static const uint8_t PEAK_BIN = 70;
+// the window of the peak, BAND_BINS from GRID_BEFORE, the same bins on every grid
+static const uint8_t BAND_BINS = ((TEST_END_TIME - TEST_START_TIME) / TEST_STEP_TIME) + 1;
+static const uint8_t GRID_BEFORE = PEAK_BIN + TEST_START_TIME / int(TEST_STEP_TIME);
+static const uint8_t GRID_AFTER = MAX_RESULT - GRID_BEFORE - BAND_BINS;
+// reach of the band (ms), at most half the bins of each side
+static const int BAND_MIN_BEFORE = -TEST_START_TIME;
+static const int BAND_MIN_AFTER = TEST_END_TIME;
+static const int BAND_MAX_BEFORE = PEAK_BIN / 2 * int(TEST_STEP_TIME);
+static const int BAND_MAX_AFTER = (MAX_RESULT - 1 - PEAK_BIN) / 2 * int(TEST_STEP_TIME);
+// the least reach of the grid, all the steps of TEST_STEP_TIME
+static const int GRID_MIN_START = -PEAK_BIN * int(TEST_STEP_TIME);
+static const int GRID_MIN_END = (MAX_RESULT - 1 - PEAK_BIN) * int(TEST_STEP_TIME);
+
+// times (ms from the peak) of the bins of a result. The edges are the first
+// and the last sample of the test that created it, the next runs are resampled
+// on the same bins. Out of the band (before, after ms around the peak) the
+// steps are TEST_STEP_TIME * r^k, r found so that the n steps end at the edge
+struct Grid
+{
+	int32_t times[MAX_RESULT];
+
+	Grid(int start = GRID_MIN_START, int end = GRID_MIN_END,
+		 int before = BAND_MIN_BEFORE, int after = BAND_MIN_AFTER)
+	{
+		start = std::min(start, GRID_MIN_START);
+		end = std::max(end, GRID_MIN_END);
+		// first and last bin of the band
+		const uint8_t first = PEAK_BIN - clampBand(before, BAND_MIN_BEFORE, BAND_MAX_BEFORE) / int(TEST_STEP_TIME);
+		const uint8_t last = PEAK_BIN + clampBand(after, BAND_MIN_AFTER, BAND_MAX_AFTER) / int(TEST_STEP_TIME);
+		for (uint8_t bin = first; bin <= last; bin++)
+			times[bin] = (bin - PEAK_BIN) * int(TEST_STEP_TIME);
+		const float ratio_before = geometricRatio(times[first] - start, first);
+		const float ratio_after = geometricRatio(end - times[last], MAX_RESULT - 1 - last);
+		float offset = 0, step = TEST_STEP_TIME;
+		for (uint8_t k = 1; k <= first; k++)
+		{
+			step *= ratio_before;
+			offset += step;
+			times[first - k] = k == first ? start : times[first] - lroundf(offset);
+		}
+		offset = 0;
+		step = TEST_STEP_TIME;
+		for (uint8_t k = 1; last + k < MAX_RESULT; k++)
+		{
+			step *= ratio_after;
+			offset += step;
+			times[last + k] = last + k == MAX_RESULT - 1 ? end : times[last] + lroundf(offset);
+		}
+	}
+
+	// the bins of a result by strain: their index, no time to take for the peak
+	static Grid strain()
+	{
+		Grid grid;
+		for (uint8_t bin = 0; bin < MAX_RESULT; bin++)
+			grid.times[bin] = bin;
+		return grid;
+	}
+
+	int start() const { return times[0]; }
+	int end() const { return times[MAX_RESULT - 1]; }
+	int operator[](uint8_t bin) const { return times[bin]; }
+
+	// bin of a relative time (ms), -1 if not on the grid
+	int index(int time) const
+	{
+		const int32_t *it = std::lower_bound(times, times + MAX_RESULT, time);
+		if (it == times + MAX_RESULT || *it != time)
+			return -1;
+		return it - times;
+	}
+
+	// the grid of a result, false if the file has other bins (before the grid)
+	bool read(DataArray<MAX_RESULT, ResultBin> &data)
+	{
+		if (data.size() != MAX_RESULT)
+			return false;
+		for (uint8_t bin = 0; bin < MAX_RESULT; bin++)
+			times[bin] = data[bin]->time;
+		return true;
+	}
+
+	// a reach of the band in steps of TEST_STEP_TIME
+	static int clampBand(int band, int least, int most)
+	{
+		return std::min(std::max(band, least), most) / int(TEST_STEP_TIME) * int(TEST_STEP_TIME);
+	}
+};
+
+DataArray<MAX_RESULT, ResultBin> accumulated_data;
+
+// how a run is placed on the bins of the result
+enum Align
+{
+    ALIGN_PEAK,  // the max force sample
+    ALIGN_XCORR  // the shift that best correlates the curve before the peak with the result
+};
+// shifts tried by ALIGN_XCORR around the peak (ms)
+static const int ALIGN_MAX_LAG = 3 * TEST_STEP_TIME;
+static const int ALIGN_LAG_STEP = TEST_STEP_TIME / 4;
 
 void clear(){
 	accumulated_data.clear();
 }
 void clearData(){
-    test_data.clear();
+    recent.clear();
+    peak_window.clear();
+    preTrigger.clear();
+    samples = 0;
+    window_closed = false;
+    window_full = false;
+    align_shift = 0;
+    first_time = 0;
+    last_time = 0;
+    properties.reset();
+    peak_force = 0;
+    peak_time = 0;
+}
+
+// the samples of the next test are saved in path, "" for RAM only
+void setStream(const char *path){
+    endStream();
+    strncpy(stream_path, path, sizeof(stream_path) - 1);
+}
+void endStream(){
+    sample_log.end();
+}
+bool isStreaming(){
+    return sample_log.isOpen();
+}
+// the samples of the last test to path, kept with the result it's saved in
+bool moveStream(const char *path){
+    if (!stream_path[0] || isStreaming() || !strcmp(stream_path, path))
+        return false;
+    if (LittleFS.exists(path))
+        LittleFS.remove(path);
+    if (!LittleFS.rename(stream_path, path))
+        return false;
+    strncpy(stream_path, path, sizeof(stream_path) - 1);
+    return true;
 }
 
 bool isEmpty(){
     return accumulated_data.size() < 1;
 }
 
+// calibration of the next test, the samples are kept in counts until addTest
+void setCalibration(const Calibration &calibration){
+    this->calibration = calibration;
+}
+const Calibration &getCalibration(){
+    return calibration;
+}
+
+// specimen of the next test, after setCalibration()
+// length in mm for the 0.2% offset yield, band in kg for the modulus fit
+void setSpecimen(float length, float band_low, float band_high){
+    band_low_counts = calibration.fromKg(band_low);
+    band_high_counts = calibration.fromKg(band_high);
+    properties.begin(band_low_counts, band_high_counts, lroundf(length * 1000.0f * 0.002f));
+}
+
+// summary of the last test, computed while it ran
+TestProperties getProperties(float length, float area){
+    return properties.get(calibration, length, area);
+}
+
+// the summary for a specimen known after the test ran (the one of the result
+// it's saved in): its SampleLog again through a tracker with that length.
+// The one computed while it ran if the samples are not saved
+TestProperties getProperties(float length, float area, bool replay){
+    static SampleBlock block;
+    SampleLogReader reader;
+    if (!replay || !stream_path[0] || isStreaming() || !reader.open(stream_path))
+        return getProperties(length, area);
+
+    PropertyTracker tracker;
+    tracker.begin(band_low_counts, band_high_counts, lroundf(length * 1000.0f * 0.002f));
+    for (uint32_t b = 0; b < reader.getBlocks() && reader.readBlock(b, block); b++)
+        for (uint32_t i = 0; i < block.count; i++)
+            tracker.add(lroundf(block.samples[i].distance * 1000.0f), block.samples[i].force);
+    reader.close();
+    return tracker.get(calibration, length, area);
+}
+
+// time in ms from the trigger, force in kg
 bool addPoint(float distance, float force, int time){
-    SensorItem *item = test_data.getEmpty();
-    if (item)
+    return addSample(distance, force, int64_t(time) * 1000);
+}
+
+// force in kg, timestamp in us from the trigger
+bool addSample(float distance, float force, int64_t timestamp){
+    return addRaw(distance, calibration.fromKg(force), timestamp);
+}
+
+// net counts (Calibration::net) and timestamp in us from the trigger,
+// as captured by LoadCellSampler, no float work on the force
+// false if the flash is full
+bool addRaw(float distance, int32_t counts, int64_t timestamp){
+    if (sample_log.isOpen() && !sample_log.add(timestamp, distance, counts))
+        return false;
+
+    recent.push(timestamp, distance, counts);
+    properties.add(lroundf(distance * 1000.0f), counts);
+    if (samples == 0)
+        first_time = timestamp;
+    last_time = timestamp;
+
+    if (samples++ == 0 || counts > peak_force)
+    {
+        // new peak candidate, its window starts with the last samples
+        peak_force = counts;
+        peak_time = timestamp;
+        peak_window = recent;
+        window_closed = false;
+        window_full = false;
+    }
+    else if (!window_full)
     {
-        item->set(distance, force, time);
-        test_data.push(item);
-        return true;
-    } 
-    return false;
+        // one sample after TEST_END_TIME to interpolate, then it is complete.
+        // ALIGN_MAX_LAG more if they arrive, the room of a later alignment
+        peak_window.push(timestamp, distance, counts);
+        window_closed = window_closed || timestamp > peak_time + TEST_END_TIME * 1000;
+        window_full = timestamp > peak_time + (TEST_END_TIME + ALIGN_MAX_LAG) * 1000;
+    }
+    return true;
+}
+
+// the window of the peak has all its samples, addTest() won't extrapolate the end
+bool isWindowReady(){
+    return window_closed;
+}
+// and ALIGN_MAX_LAG more, ALIGN_XCORR can shift the window both ways
+bool isAlignReady(){
+    return window_full;
 }
 
+// num_tests only for old result files, see migrate()
 void addTest(size_t num_tests = 0)
 {
-	size_t rupture_index = detect_rupture();
-	int rupture_time = test_data[rupture_index]->time;
+	float distance[MAX_RESULT], force[MAX_RESULT];
+	resample(distance, force);
+	migrate(accumulated_data, num_tests);
+	accumulate(accumulated_data, grid, distance, force);
+}
+
+void setAlign(Align mode){
+    align = mode;
+}
+Align getAlign(){
+    return align;
+}
+// shift (ms) from the peak of the last resample()
+float getAlignShift(){
+    return align_shift / 1000.0f;
+}
+// the grid of the last resample()
+const Grid &getGrid(){
+    return grid;
+}
+// reach of the band (ms around the peak) of the grid of a new result
+void setBand(int before, int after){
+    band_before = before;
+    band_after = after;
+}
+
+// the bins of the last test (mm, kg), what RunStore keeps of every run.
+// On the grid of accumulated_data, or on one from the start and the end of
+// this test if it's empty or from an old file
+void resample(float distance[MAX_RESULT], float force[MAX_RESULT])
+{
+	int64_t rupture_time = detect_rupture();
+	align_shift = rupture_time - peak_time;
+	if (!grid.read(accumulated_data))
+		grid = Grid((first_time - rupture_time) / 1000, (last_time - rupture_time) / 1000, band_before, band_after);
 
-	for (int rel_time = TEST_START_TIME; rel_time <= TEST_END_TIME; rel_time += TEST_STEP_TIME)
+	// the window around the peak was captured while the test ran,
+	// one pass over its samples for the band
+	Resampler<SampleBuffer<WINDOW_SAMPLES>> walk(peak_window);
+
+	for (uint8_t bin = GRID_BEFORE; bin < GRID_BEFORE + BAND_BINS; bin++)
 	{
-		int target_time = rupture_time + rel_time;
+		int64_t target_time = rupture_time + grid[bin] * 1000;
+
+		int32_t counts = 0;
+		distance[bin] = 0.0f;
+		if (walk.seek(target_time))
+		{
+			distance[bin] = walk.interpolate(peak_window.distance(walk.prev()), peak_window.distance(walk.next()));
+			counts = std::max<int32_t>(0, walk.interpolate(peak_window.force(walk.prev()), peak_window.force(walk.next())));
+		}
+		// the only conversion of the force to kg
+		force[bin] = calibration.toKg(counts);
+	}
 
-		float distance = calculate_distance(target_time);
-		float force = calculate_force(target_time);
+	// the long steps out of the band, from the whole test
+	if (!resampleLog(rupture_time, distance, force))
+		resampleOuter(rupture_time, distance, force);
+}
+
+// strain of the last bin of a new strain result, from the break of its first run
+static constexpr float STRAIN_MARGIN = 1.25f;
+
+// the whole curve of the last test (its SampleLog) on a grid of strain:
+// bin i at i * step (mm/mm), length of the specimen of the test. The bins
+// keep the distance in mm of result_length, the force is 0 after the end
+// of the log (broken). One pass over the blocks, the distance only grows
+bool resampleStrain(float length, float step, float result_length,
+					float distance[MAX_RESULT], float force[MAX_RESULT])
+{
+	static SampleBlock block;
+	SampleLogReader reader;
+	if (!stream_path[0] || isStreaming() || length <= 0 || step <= 0 || !reader.open(stream_path))
+		return false;
 
-		SensorItem *acc_item = nullptr;
-		for (SensorItem *item : accumulated_data)
+	uint8_t bin = 0;
+	float prev_strain = 0;
+	int32_t prev_counts = 0;
+	bool has_prev = false;
+	for (uint32_t b = 0; b < reader.getBlocks() && bin < MAX_RESULT; b++)
+	{
+		if (!reader.readBlock(b, block))
+			break;
+		for (uint32_t i = 0; i < block.count && bin < MAX_RESULT; i++)
 		{
-			if (item->time == rel_time)
+			const float strain = block.samples[i].distance / length;
+			const int32_t counts = block.samples[i].force;
+			// every bin crossed by this sample
+			for (; bin < MAX_RESULT && strain >= bin * step; bin++)
 			{
-				acc_item = item;
-				break;
+				float f = counts;
+				if (has_prev && strain > prev_strain)
+					f = prev_counts + (counts - prev_counts) * (bin * step - prev_strain) / (strain - prev_strain);
+				distance[bin] = bin * step * result_length;
+				force[bin] = calibration.toKg(std::max<int32_t>(0, lroundf(f)));
 			}
+			prev_strain = strain;
+			prev_counts = counts;
+			has_prev = true;
 		}
+	}
+	reader.close();
+	for (; bin < MAX_RESULT; bin++)
+	{
+		distance[bin] = bin * step * result_length;
+		force[bin] = 0;
+	}
+	return true;
+}
+
+// step of the strain grid of a result, its last bin, 0 if not found
+static float strainStep(DataArray<MAX_RESULT, ResultBin> &data, float result_length)
+{
+	ResultBin *last = getBin(data, MAX_RESULT - 1);
+	if (!last || result_length <= 0)
+		return 0;
+	return last->distance / result_length / (MAX_RESULT - 1);
+}
+
+// a result file saved before the bins had their count, when it's loaded.
+// tests of the history, the bins with a count are kept
+static void migrate(DataArray<MAX_RESULT, ResultBin> &data, uint16_t tests)
+{
+	if (tests == 0)
+		return;
+	for (ResultBin *item : data)
+		if (item->count == 0)
+			item->migrate(tests);
+}
+
+// folds the bins of one run in data, O(bins). grid gives the times of the
+// bins data doesn't have, a new result or a file saved with other bins
+static void accumulate(DataArray<MAX_RESULT, ResultBin> &data, const Grid &grid,
+					   const float distance[MAX_RESULT], const float force[MAX_RESULT])
+{
+	// a result file saved with other bins gets the missing ones in its order
+	const bool insert = data.size() > 0;
+	bool sorted = true;
+	for (uint8_t bin = 0; bin < MAX_RESULT; bin++)
+	{
+		// by its time until the result has all its bins
+		ResultBin *acc_item = data.size() == MAX_RESULT ? data[bin] : getPoint(data, grid[bin]);
 
 		if (!acc_item)
 		{
-			acc_item = accumulated_data.getEmpty();
-			acc_item->time = rel_time;
-			acc_item->distance = distance;
-			acc_item->force = force;
-			acc_item->min = force;
-			acc_item->max = force;
-			accumulated_data.push(acc_item);
-		}
-		else
-		{
-			// Actualizar media acumulada
-			acc_item->distance = (acc_item->distance * num_tests + distance) / (num_tests + 1);
-			acc_item->force = (acc_item->force * num_tests + force) / (num_tests + 1);
-
-			// Actualizar min/max
-			acc_item->max = std::max(acc_item->max, force);
-			acc_item->min = std::min(acc_item->min, force);
+			acc_item = data.getEmpty();
+			acc_item->set(0, 0, grid[bin]);
+			acc_item->resetStats();
+			data.push(acc_item);
+			sorted = !insert;
 		}
+		acc_item->accumulate(distance[bin], force[bin]);
 	}
+	if (!sorted)
+		data.sort([](ResultBin *a, ResultBin *b) { return a->time < b->time; });
 }
 
-SensorItem* getPoint(int time){
-    for (SensorItem *acc_item : accumulated_data)
-    {
+// the bins are stored in order, direct access. A result file with
+// other bins only has the band, at the same times on every grid
+ResultBin *getBin(uint8_t bin){
+    return getBin(accumulated_data, bin);
+}
+static ResultBin *getBin(DataArray<MAX_RESULT, ResultBin> &data, uint8_t bin){
+    if (data.size() == MAX_RESULT)
+        return data[bin];
+    if (bin < GRID_BEFORE || bin >= GRID_BEFORE + BAND_BINS)
+        return nullptr;
+    return getPoint(data, TEST_START_TIME + (bin - GRID_BEFORE) * int(TEST_STEP_TIME));
+}
+
+// before the trigger, keeps the last PRE_TRIGGER_TIME ms (net counts, timestamp in us, absolute)
+void addPreTrigger(float distance, int32_t counts, int64_t timestamp){
+    preTrigger.push(timestamp, distance, counts);
+}
+
+// the trigger fired, the pre-trigger samples go in front with negative timestamps
+void trigger(float zero_distance, int64_t zero_time){
+    if (stream_path[0] && !sample_log.begin(stream_path, SAMPLE_RATE, zero_time, calibration))
+        Serial.println("SampleLog not available, the samples of the test are not saved");
+
+    for (uint32_t i = 0; i < preTrigger.size(); i++)
+        addRaw(preTrigger.distance(i) - zero_distance, preTrigger.force(i), preTrigger.time(i) - zero_time);
+    preTrigger.clear();
+}
+
+// the bin of a relative time (ms), nullptr if not on the grid
+ResultBin* getPoint(int time){
+    return getPoint(accumulated_data, time);
+}
+static ResultBin *getPoint(DataArray<MAX_RESULT, ResultBin> &data, int time){
+    for (ResultBin *acc_item : data)
         if (acc_item->time == time)
-        {
             return acc_item;
-        }
-    }
     return nullptr;
 }
 
 private:
 
-static const uint MAX_RAW_DATA = TEST_MAX_TIME / TEST_STEP_TIME;
-DataArray<MAX_RAW_DATA, SensorItem> test_data;
+static const uint MAX_PRE_TRIGGER = PRE_TRIGGER_TIME * SAMPLE_RATE / 1000;
+// TEST_START_TIME..TEST_END_TIME twice, margin for the neighbours and jitter
+static const uint WINDOW_SAMPLES = 2 * (TEST_END_TIME - TEST_START_TIME) * SAMPLE_RATE / 1000;
+// the last samples, the start of the window of a new peak
+SampleBuffer<WINDOW_SAMPLES> recent;
+// samples around the peak candidate, the ring keeps the newest
+// so after the peak it only grows until TEST_END_TIME
+SampleBuffer<WINDOW_SAMPLES> peak_window;
+bool window_closed = false;
+bool window_full = false;
+uint32_t samples = 0;
+// first and last sample of the test (us), the edges of a new grid
+int64_t first_time = 0;
+int64_t last_time = 0;
+Grid grid;
+int band_before = BAND_MIN_BEFORE;
+int band_after = BAND_MIN_AFTER;
+int32_t peak_force = 0; // counts
+int64_t peak_time = 0;
+Align align = ALIGN_PEAK;
+int64_t align_shift = 0; // us
+Calibration calibration;
+PropertyTracker properties;
+int32_t band_low_counts = 0; // band of the modulus fit of the test
+int32_t band_high_counts = 0;
+
+SampleLog sample_log;
+char stream_path[55] = "";
+
+SampleBuffer<MAX_PRE_TRIGGER> preTrigger;
 
 // Función para detectar la ruptura
-size_t detect_rupture()
+// el maximo se sigue en addRaw, con su ventana
+int64_t detect_rupture()
 {
-	float max_force = 0;
-	size_t rupture_index = 0;
-	for (size_t i = 0; i < test_data.size(); ++i)
-	{
-		if (test_data[i]->force > max_force)
-		{
-			max_force = test_data[i]->force;
-			rupture_index = i;
-		}
-	}
-	return rupture_index;
+	if (align == ALIGN_XCORR)
+		return correlate_rupture();
+	return peak_time;
 }
 
-// Función para calcular distancia interpolada/extrapolada
-float calculate_distance(int target_time)
+// bounded lag cross-correlation of the window of the run with the mean of
+// the result (normalized, the level and the scale of a run don't count).
+// O(lags * (samples + bins)), 25 lags of 5ms. The drop of the break is in
+// the window, the rise alone correlates almost the same at any shift.
+// Only the band, the peak if none correlates. The lags are the same both
+// ways, as far as the window has samples on the short side: a window cut
+// after the peak would only try negative shifts
+int64_t correlate_rupture()
 {
-	if (test_data.size() < 2)
-		return 0.0f;
+	float ref[BAND_BINS];
+	float ref_mean = 0;
+	for (uint8_t bin = 0; bin < BAND_BINS; bin++)
+	{
+		ResultBin *item = getBin(GRID_BEFORE + bin);
+		if (!item || item->count == 0)
+			return peak_time;
+		ref[bin] = item->force;
+		ref_mean += ref[bin] / BAND_BINS;
+	}
+	float ref_norm = 0;
+	for (float &r : ref)
+	{
+		r -= ref_mean;
+		ref_norm += r * r;
+	}
+	if (ref_norm <= 0 || peak_window.size() < 2)
+		return peak_time;
 
-	SensorItem *prev = nullptr;
-	SensorItem *next = nullptr;
+	const int64_t first = peak_window.time(0);
+	const int64_t last = peak_window.time(peak_window.size() - 1);
+	const int64_t room = std::min<int64_t>(peak_time - first + TEST_START_TIME * 1000,
+										   last - peak_time - TEST_END_TIME * 1000);
+	const int max_lag = std::min<int64_t>(ALIGN_MAX_LAG, std::max<int64_t>(room, 0) / 1000) / ALIGN_LAG_STEP * ALIGN_LAG_STEP;
+	int64_t best_time = peak_time;
+	float best = 0;
 
-	for (SensorItem *item : test_data)
+	Resampler<SampleBuffer<WINDOW_SAMPLES>> walk(peak_window);
+	for (int lag = 0; lag <= 2 * max_lag; lag += ALIGN_LAG_STEP)
 	{
-		if (item->time <= target_time)
-			prev = item;
-		if (item->time > target_time && !next)
+		// 0, +5, -5, +10... a tie keeps the smallest shift
+		const int shift = (lag / ALIGN_LAG_STEP) % 2 ? (lag + ALIGN_LAG_STEP) / 2 : -lag / 2;
+		const int64_t rupture = peak_time + int64_t(shift) * 1000;
+		if (rupture + TEST_START_TIME * 1000 < first || rupture + TEST_END_TIME * 1000 > last)
+			continue;
+
+		float x[BAND_BINS];
+		float x_mean = 0;
+		walk.rewind();
+		for (uint8_t bin = 0; bin < BAND_BINS; bin++)
 		{
-			next = item;
-			break;
+			walk.seek(rupture + grid[GRID_BEFORE + bin] * 1000);
+			x[bin] = walk.interpolate(peak_window.force(walk.prev()), peak_window.force(walk.next()));
+			x_mean += x[bin] / BAND_BINS;
+		}
+		float dot = 0, x_norm = 0;
+		for (uint8_t bin = 0; bin < BAND_BINS; bin++)
+		{
+			const float dx = x[bin] - x_mean;
+			dot += dx * ref[bin];
+			x_norm += dx * dx;
+		}
+		if (x_norm <= 0)
+			continue;
+		const float score = dot / sqrtf(x_norm * ref_norm);
+		if (score > best)
+		{
+			best = score;
+			best_time = rupture;
 		}
 	}
+	return best_time;
+}
 
-	if (!prev)
-	{
-		// Extrapolar hacia atrás
-		prev = test_data[0];
-		next = test_data[1];
-	}
-	else if (!next)
+// r > 1 of steps TEST_STEP_TIME * r^k, k = 1..n, that add up to span (ms), bisection
+static float geometricRatio(float span, uint8_t n)
+{
+	float lo = 1.0f, hi = 4.0f;
+	for (uint8_t i = 0; i < 40; i++)
 	{
-		// Extrapolar hacia adelante
-		prev = test_data[test_data.size() - 2];
-		next = test_data[test_data.size() - 1];
+		const float r = (lo + hi) / 2;
+		float sum = 0, step = TEST_STEP_TIME;
+		for (uint8_t k = 0; k < n; k++)
+			sum += (step *= r);
+		(sum < span ? lo : hi) = r;
 	}
-	// Interpolar
-	float slope = (next->distance - prev->distance) / (next->time - prev->time);
-	return prev->distance + slope * (target_time - prev->time);
+	return (lo + hi) / 2;
 }
-// Función para calcular fuerza interpolada/extrapolada
-float calculate_force(int target_time)
+
+// the bins out of the band from the SampleLog of the test, one pass over
+// its blocks with a jump over the band. Before the first sample and after
+// the last one, the sample of the end. false if there is no log
+bool resampleLog(int64_t rupture_time, float distance[MAX_RESULT], float force[MAX_RESULT])
 {
-	if (test_data.size() < 2)
-		return 0.0f;
+	static SampleBlock block;
+	SampleLogReader reader;
+	if (!stream_path[0] || isStreaming() || !reader.open(stream_path))
+		return false;
 
-	SensorItem *prev = nullptr;
-	SensorItem *next = nullptr;
+	uint32_t b = 0, i = 0;
+	bool loaded = reader.readBlock(0, block);
+	if (!loaded)
+	{
+		reader.close();
+		return false;
+	}
+	// the two samples around the target
+	int64_t t0 = 0, t1 = 0;
+	float d0 = 0, d1 = 0;
+	int32_t c0 = 0, c1 = 0;
+	uint8_t have = 0;
 
-	for (SensorItem *item : test_data)
+	for (uint8_t bin = 0; bin < MAX_RESULT; bin++)
 	{
-		if (item->time <= target_time)
-			prev = item;
-		if (item->time > target_time && !next)
+		if (bin == GRID_BEFORE)
 		{
-			next = item;
-			break;
+			bin += BAND_BINS;
+			// the block before the one of the target, it has the sample before it
+			const uint32_t jump = reader.findBlock(rupture_time + grid[bin] * 1000);
+			if (jump > b + 1)
+			{
+				b = jump - 1;
+				loaded = reader.readBlock(b, block);
+				i = 0;
+				have = 0;
+			}
+		}
+		const int64_t target = rupture_time + grid[bin] * 1000;
+		while (have == 0 || t1 < target)
+		{
+			while (loaded && i >= block.count)
+			{
+				loaded = reader.readBlock(++b, block);
+				i = 0;
+			}
+			if (!loaded)
+				break;
+			t0 = t1;
+			d0 = d1;
+			c0 = c1;
+			t1 = block.timeAt(i);
+			d1 = block.samples[i].distance;
+			c1 = block.samples[i].force;
+			have = std::min(have + 1, 2);
+			i++;
 		}
-	}
 
-	if (!prev)
-	{
-		// Extrapolar hacia atrás
-		prev = test_data[0];
-		next = test_data[1];
+		float f = c1;
+		distance[bin] = d1;
+		if (have == 2 && t1 >= target && t1 > t0)
+		{
+			const float k = float(target - t0) / float(t1 - t0);
+			distance[bin] = d0 + (d1 - d0) * k;
+			f = c0 + (c1 - c0) * k;
+		}
+		force[bin] = calibration.toKg(std::max<int32_t>(0, lroundf(f)));
 	}
-	else if (!next)
+	reader.close();
+	return true;
+}
+
+// without a log: the window where it has samples, before it a line from the
+// trigger (0mm, 0kg) to its first sample and after it its last sample
+void resampleOuter(int64_t rupture_time, float distance[MAX_RESULT], float force[MAX_RESULT])
+{
+	const uint32_t size = peak_window.size();
+	for (uint8_t bin = 0; bin < MAX_RESULT; bin++)
 	{
-		// Extrapolar hacia adelante
-		prev = test_data[test_data.size() - 2];
-		next = test_data[test_data.size() - 1];
-	}
+		if (bin == GRID_BEFORE)
+			bin += BAND_BINS;
+		const int64_t target = rupture_time + grid[bin] * 1000;
+		distance[bin] = 0.0f;
+		force[bin] = 0.0f;
+		if (size < 2 || target <= 0)
+			continue;
 
-	// Interpolar
-	float slope = (next->force - prev->force) / (next->time - prev->time);
-	return std::max(0.0f, prev->force + slope * (target_time - prev->time));
+		// samples a and b around the target, a < 0 the trigger
+		int32_t a = -1;
+		uint32_t b = 0;
+		while (b + 1 < size && peak_window.time(b) <= target)
+			a = b++;
+		const int64_t ta = a < 0 ? 0 : peak_window.time(a);
+		const float da = a < 0 ? 0.0f : peak_window.distance(a);
+		const int32_t fa = a < 0 ? 0 : peak_window.force(a);
+		float k = peak_window.time(b) > ta ? float(target - ta) / float(peak_window.time(b) - ta) : 1.0f;
+		k = std::min(k, 1.0f);
+		distance[bin] = da + (peak_window.distance(b) - da) * k;
+		force[bin] = calibration.toKg(std::max<int32_t>(0, lroundf(fa + (peak_window.force(b) - fa) * k)));
+	}
 }
+
 };
 
 #endif // TESTANALYZER_H
\ No newline at end of file
@@ -4,6 +4,8 @@
 #include "arduino.h"
 
 #include <DataTable.h>
+#include "Quantile.h"
+#include "MaterialProperties.h"
 
 /*    datos    */
 struct Config : public Item
@@ -23,6 +25,11 @@ struct Config : public Item
 	float home_pos = 30.0;
 	float max_travel = 100.0;
 	float max_force = 10.0;
+	// zero tracked while idle, the test starts without tare
+	bool auto_zero = true;
+	// band of steps of 20 ms around the peak of a new result (ms)
+	uint16_t band_before = 200;
+	uint16_t band_after = 100;
 
 	bool setAdmin(const char *www_user, const char *www_pass)
 	{
@@ -89,6 +96,9 @@ struct Config : public Item
 		obj["home_pos"] = this->home_pos;
 		obj["max_travel"] = this->max_travel;
 		obj["max_force"] = this->max_force;
+		obj["auto_zero"] = this->auto_zero;
+		obj["band_before"] = this->band_before;
+		obj["band_after"] = this->band_after;
 	};
 
 	bool deserializeItem(JsonObject &obj)
@@ -109,6 +119,14 @@ struct Config : public Item
 		setSpeedAcceleration(obj["speed"], obj["acc_desc"]);
 		setMotor(obj["screw_pitch"], obj["micro_step"], obj["invert_motor"]);
 		setHome(obj["home_pos"], obj["max_travel"], obj["max_force"]);
+		// optional, config files older than the baseline tracker
+		if (obj["auto_zero"].is<bool>())
+			auto_zero = obj["auto_zero"];
+		if (obj["band_before"].is<uint16_t>() && obj["band_after"].is<uint16_t>())
+		{
+			band_before = obj["band_before"];
+			band_after = obj["band_after"];
+		}
 
 		return true;
 	};
@@ -121,6 +139,8 @@ struct SensorItem : public Item
 	int time = 0;
 	float min = 0.0; // Mínimo de fuerza
 	float max = 0.0; // Máximo de fuerza
+	// esp_timer time (us) of the HX711 conversion, relative to the trigger in raw test data
+	int64_t timestamp = 0;
 
 	void set(float distance, float force, int time = 0)
 	{
@@ -128,10 +148,25 @@ struct SensorItem : public Item
 		this->force = force;
 		this->time = time;
 	};
+	void setSample(float distance, float force, int64_t timestamp)
+	{
+		set(distance, force, timestamp / 1000);
+		this->timestamp = timestamp;
+	};
+	// extra, the copy for the clients: rounded. The file keeps the full
+	// float, a result reloads its mean to add the next test to it
 	void serializeItem(JsonObject &obj, bool extra = false)
 	{
-		obj["d"] = round(this->distance * 1000.0) / 1000.0;
-		obj["f"] = round(this->force * 100.0) / 100.0;
+		if (extra)
+		{
+			obj["d"] = round(this->distance * 1000.0) / 1000.0;
+			obj["f"] = round(this->force * 100.0) / 100.0;
+		}
+		else
+		{
+			obj["d"] = this->distance;
+			obj["f"] = this->force;
+		}
 		obj["t"] = this->time;
 		obj["mi"] = round(this->min * 100.0) / 100.0;
 		obj["ma"] = round(this->max * 100.0) / 100.0;
@@ -154,6 +189,136 @@ struct SensorItem : public Item
 	};
 };
 
+// a bin of an averaged result: the mean of the tests (SensorItem) and what
+// is needed to add the next one, only the results keep it
+struct ResultBin : public SensorItem
+{
+	// tests in the bin and the sum of the squared differences
+	// of the force to the mean (Welford)
+	uint16_t count = 0;
+	float m2 = 0.0;
+	// robust band of the force, P10/P50/P90 of the runs of the result
+	// (OutlierCheck::RunSet::setBand), bandCount runs in it, 0 none
+	float p10 = 0, p50 = 0, p90 = 0;
+	uint16_t bandCount = 0;
+
+	// a new bin
+	void resetStats()
+	{
+		count = 0;
+		m2 = 0;
+		setBand(0, 0, 0, 0);
+	};
+	void setBand(float p10, float p50, float p90, uint16_t runs)
+	{
+		this->p10 = p10;
+		this->p50 = p50;
+		this->p90 = p90;
+		bandCount = runs;
+	};
+	// one more test in the bin, running mean without the drift of avg * n.
+	// The band is rebuilt from the runs afterwards
+	void accumulate(float distance, float force)
+	{
+		count++;
+		this->distance += (distance - this->distance) / count;
+		float delta = force - this->force;
+		this->force += delta / count;
+		m2 += delta * (force - this->force);
+		if (count == 1 || force < min)
+			min = force;
+		if (count == 1 || force > max)
+			max = force;
+	};
+	// sample variance and standard deviation of the force, 0 with one test
+	float variance()
+	{
+		return count > 1 ? m2 / (count - 1) : 0;
+	};
+	float stddev()
+	{
+		return sqrtf(variance());
+	};
+	// result files without "n" only have mean, min and max of the tests.
+	// m2 starts at the least it can be: min and max, the rest on the mean.
+	// The band comes with the runs kept from now on
+	void migrate(uint16_t tests)
+	{
+		count = tests;
+		m2 = 0;
+		if (tests > 1)
+			m2 = (min - force) * (min - force) + (max - force) * (max - force);
+	};
+	// extra, the copy for the clients (as Config). The file keeps m2 to add
+	// the next test and the runs of the band, the band is only the 3 values
+	void serializeItem(JsonObject &obj, bool extra = false)
+	{
+		SensorItem::serializeItem(obj, extra);
+		if (this->count)
+			obj["n"] = this->count;
+		if (bandCount)
+		{
+			obj["p10"] = round(p10 * 100.0) / 100.0;
+			obj["p50"] = round(p50 * 100.0) / 100.0;
+			obj["p90"] = round(p90 * 100.0) / 100.0;
+		}
+		if (extra)
+			return;
+		if (this->count)
+			obj["m2"] = this->m2;
+		if (bandCount)
+			obj["bn"] = bandCount;
+	};
+	bool deserializeItem(JsonObject &obj)
+	{
+		if (!SensorItem::deserializeItem(obj))
+			return false;
+		// 0 marks an old file, see migrate()
+		resetStats();
+		if (obj["n"].is<uint16_t>() && obj["m2"].is<float>())
+		{
+			this->count = obj["n"];
+			this->m2 = obj["m2"];
+		}
+		if (obj["bn"].is<uint16_t>() && obj["p50"].is<float>())
+			setBand(obj["p10"], obj["p50"], obj["p90"], obj["bn"]);
+		else if (obj["qs"].is<JsonArray>())
+		{
+			// results saved with the state of P2 estimators, no runs to
+			// rebuild the band from until they are kept
+			JsonArray qs = obj["qs"];
+			deserializeQuantiles(qs);
+		}
+		return true;
+	};
+
+private:
+	// the band of the P2Quantile state of P10, P50 and P90
+	void deserializeQuantiles(JsonArray &qs)
+	{
+		P2Quantile quantiles[] = {P2Quantile(0.1), P2Quantile(0.5), P2Quantile(0.9)};
+		if (qs.size() != 3)
+			return;
+		uint8_t i = 0;
+		for (JsonVariant v : qs)
+		{
+			JsonArray arr = v;
+			float state[P2Quantile::STATE_SIZE];
+			uint8_t j = 0;
+			if (arr.size() == P2Quantile::STATE_SIZE)
+				for (JsonVariant x : arr)
+					state[j++] = x.as<float>();
+			if (j != P2Quantile::STATE_SIZE || !quantiles[i].setState(state))
+			{
+				Serial.println("faill deserializeItem ResultBin quantiles");
+				return;
+			}
+			i++;
+		}
+		setBand(quantiles[0].get(), quantiles[1].get(), quantiles[2].get(), quantiles[1].getCount());
+	};
+};
+
 struct HistoryItem : public Item
 {
 	char pathData[55] = "";
@@ -163,6 +328,49 @@ struct HistoryItem : public Item
 	uint8_t averageCount = 0;
 	float length = 5;
 	float area = 2;
+	// axis of the average, fixed when the result is created
+	enum Mode
+	{
+		TIME = 0,  // time around the rupture
+		STRAIN = 1 // strain of the whole curve, with length
+	};
+	uint8_t mode = TIME;
+	// summary of the average for the history, without reading the curve file.
+	// Saved with the result, see summarize()
+	float peakForce = 0;	 // N
+	float peakStress = 0;	 // MPa
+	float peakStd = 0;		 // N, between the runs at the peak
+	float breakDistance = 0; // mm
+	float energy = 0;		 // J to break
+
+	// the summary from the bins of the result (mm, kg), as PropertyTracker:
+	// the break is the last bin over 10% of the peak, energy by trapezoids
+	template <uint N>
+	void summarize(DataArray<N, ResultBin> &data)
+	{
+		peakForce = peakStress = peakStd = breakDistance = energy = 0;
+		if (data.size() == 0)
+			return;
+
+		uint32_t peak = 0;
+		for (uint32_t i = 1; i < data.size(); i++)
+			if (data[i]->force > data[peak]->force)
+				peak = i;
+		uint32_t rupture = peak;
+		for (uint32_t i = peak + 1; i < data.size(); i++)
+			if (data[i]->force >= data[peak]->force * 0.1f)
+				rupture = i;
+
+		float work = 0; // kg mm
+		for (uint32_t i = 0; i < rupture; i++)
+			work += (data[i]->force + data[i + 1]->force) / 2 * (data[i + 1]->distance - data[i]->distance);
+
+		peakForce = data[peak]->force * GRAVITY;
+		peakStress = area > 0 ? peakForce / area : 0;
+		peakStd = data[peak]->stddev() * GRAVITY;
+		breakDistance = data[rupture]->distance;
+		energy = work * GRAVITY / 1000.0f;
+	}
 
 	void set(const char *path, const char *name, const char *date,
 			 const char *description, float length, float area, uint8_t averageCount = 0)
@@ -191,6 +399,12 @@ struct HistoryItem : public Item
 		obj["avg_count"] = this->averageCount;
 		obj["length"] = this->length;
 		obj["area"] = this->area;
+		obj["mode"] = this->mode;
+		obj["peak_f"] = round(peakForce * 100.0) / 100.0;
+		obj["peak_s"] = round(peakStress * 100.0) / 100.0;
+		obj["peak_sd"] = round(peakStd * 100.0) / 100.0;
+		obj["break_d"] = round(breakDistance * 1000.0) / 1000.0;
+		obj["energy"] = round(energy * 10000.0) / 10000.0;
 	};
 	bool deserializeItem(JsonObject &obj)
 	{
@@ -209,6 +423,14 @@ struct HistoryItem : public Item
 			obj["path"], obj["name"], obj["date"],
 			obj["description"],
 			obj["length"], obj["area"], obj["avg_count"]);
+		// results before the modes are by time
+		this->mode = obj["mode"].is<uint8_t>() && obj["mode"].as<uint8_t>() == STRAIN ? STRAIN : TIME;
+		// results before the summary get it with the next average or reprocess
+		peakForce = obj["peak_f"].is<float>() ? obj["peak_f"].as<float>() : 0;
+		peakStress = obj["peak_s"].is<float>() ? obj["peak_s"].as<float>() : 0;
+		peakStd = obj["peak_sd"].is<float>() ? obj["peak_sd"].as<float>() : 0;
+		breakDistance = obj["break_d"].is<float>() ? obj["break_d"].as<float>() : 0;
+		energy = obj["energy"].is<float>() ? obj["energy"].as<float>() : 0;
 		return true;
 	};
 };
@@ -6,6 +6,7 @@
 
 #include "Arduino.h"
 #include <algorithm>
+#include <atomic>
 
 #include "HX711.h"
 
@@ -13,9 +14,17 @@
 #include <FileJsonManager.h>
 #include <MotorController.h>
 #include <ServerManager.h>
+#include <LoadCellSampler.h>
+#include <StreamFilter.h>
 
 #include "data.h"
 #include "TestAnalyzer.h"
+#include "Calibration.h"
+#include "Tare.h"
+#include "BreakDetector.h"
+#include "OverloadGuard.h"
+#include "RunStore.h"
+#include "OutlierCheck.h"
 
 // host name to mDNS, http://plastester.local
 const char *hostName = "plastester";
@@ -24,6 +33,20 @@ const int LOADCELL_DOUT_PIN = 26;
 const int LOADCELL_SCK_PIN = 25;
 const float CALIBRATING_FACTOR = -2316138 / 44.34; // read/real kg
 HX711 scale;
+// raw counts to kg, only applied to the outputs
+Calibration calibration;
+// reads every conversion in its own task, see LoadCellSampler.h
+LoadCellSampler sampler;
+// filter of the force while a test runs, selected by the run command
+StreamFilter forceFilter;
+// zero of the scale, fed by readSensors, see Tare.h
+Tare tare;
+BaselineTracker baseline;
+const uint32_t BASELINE_MAX_AGE = 5000; // ms, older needs a tare before the test
+// stops the motor from the sampler task when the specimen breaks
+BreakDetector breakDetector;
+// and over Config::max_force, in any state
+OverloadGuard overload;
 
 // motor
 const uint8_t MOTOR_STEP_PIN = 32;
@@ -42,10 +65,20 @@ Config config;
 
 //		current sencor
 SensorItem currentSensor;
+int32_t currentCounts = 0; // net counts of the last sample
 TestAnalyzer analyzer;
+// specimen of the last test, for its properties
+float testLength = 0; // mm
+float testArea = 0;	  // mm2
+bool testSpecimen = false; // the run gave length and area, else those of the result it goes in
 
 const uint8_t MAX_HISTORY = 20;
 DataArray<MAX_HISTORY, HistoryItem> history;
+// every run of the results, next to their json, see RunStore.h
+typedef RunStore<TestAnalyzer::MAX_RESULT> ResultRuns;
+ResultRuns runStore;
+// a result other than the last test, to send it, recompute it or by strain, one at a time
+DataArray<TestAnalyzer::MAX_RESULT, ResultBin> scratchResult;
 
 // 			APP
 //		print config json
@@ -88,6 +121,15 @@ String createJsonSensors()
 		   currentSensor.distance + ",\"f\":" +
 		   currentSensor.force + "}}";
 }
+String createJsonOverload()
+{
+	//{"ov":{"trips":1,"blocked":0,"limit":10.00,"peak":10.21}}
+	return String("{\"ov\":{\"trips\":") +
+		   overload.getTrips() + ",\"blocked\":" +
+		   overload.getBlocked() + ",\"limit\":" +
+		   calibration.toKg(overload.getLimit()) + ",\"peak\":" +
+		   calibration.toKg(overload.getPeak()) + "}}";
+}
 String createJsonHistory()
 {
 	JsonDocument root;
@@ -103,10 +145,18 @@ String createJsonHistory()
 
 	return json;
 }
+// the result file of item. The bins of a file saved before they had
+// their count get the tests of the history, see TestAnalyzer::migrate()
+bool readResult(HistoryItem *item, DataArray<TestAnalyzer::MAX_RESULT, ResultBin> &result)
+{
+	String path = String("/data") + item->pathData;
+	if (!fileManager.readJson(path.c_str(), &result))
+		return false;
+	TestAnalyzer::migrate(result, item->averageCount + 1);
+	return true;
+}
 String createJsonResults(JsonArray &array)
 {
-	static DataArray<TestAnalyzer::MAX_RESULT, SensorItem> result;
-
 	uint32_t c = millis();
 	JsonDocument root;
 	String json;
@@ -119,22 +169,16 @@ String createJsonResults(JsonArray &array)
 		HistoryItem *item = history[index];
 		if (item)
 		{
-			String path = String("/data") + item->pathData;
-
 			JsonObject obj = doc.add<JsonObject>();
-			obj["name"] = item->name;
-			obj["date"] = item->date;
-			obj["description"] = item->description;
-			obj["avg_count"] = item->averageCount;
-			obj["length"] = item->length;
-			obj["area"] = item->area;
-
-			if (fileManager.readJson(path.c_str(), &result))
+			// the history entry, with the summary of the result (peak, break)
+			item->serializeItem(obj, true);
+
+			if (readResult(item, scratchResult))
 			{
 				JsonArray arr = obj["data"].to<JsonArray>();
-				result.serializeData(arr);
+				scratchResult.serializeData(arr, true);
 				// Serial.printf("[%d] path:%s\n", index, path.c_str());
-				// Serial.println(result.serializeString() + "\n");
+				// Serial.println(scratchResult.serializeString() + "\n");
 			}
 			//
 		}
@@ -148,14 +192,27 @@ String createJsonResults(JsonArray &array)
 
 	return json;
 }
-String createJsonLastResult()
+// the summary of the last test: for the specimen of the run, with item for
+// the one of the result it was saved in if the run didn't give it. Without
+// either only N, mm and J
+TestProperties lastProperties(HistoryItem *item = nullptr)
+{
+	if (testSpecimen)
+		return analyzer.getProperties(testLength, testArea);
+	if (item)
+		return analyzer.getProperties(item->length, item->area, true);
+	return analyzer.getProperties(0, 0);
+}
+String createJsonLastResult(const TestProperties &properties = lastProperties())
 {
 	uint32_t c = millis();
 	JsonDocument root;
 	String json;
 
 	JsonArray doc = root["lastResult"].to<JsonArray>();
-	analyzer.accumulated_data.serializeData(doc);
+	analyzer.accumulated_data.serializeData(doc, true);
+	JsonObject props = root["props"].to<JsonObject>();
+	properties.serialize(props);
 
 	serializeJson(root, json); // Pretty
 
@@ -177,20 +234,45 @@ void clientConnected(AsyncWebSocketClient *client)
 
 	serializeJsonPretty(root, json);
 	server.send(json, client);
+	server.send(createJsonOverload(), client);
 
 	//Serial.printf("sendHistory total %d ms\n", millis() - c);
 }
 
 // manage data results
+
+// "/result/name.json" => "/data/result/name.runs"
+String runsPath(HistoryItem *item)
+{
+	String path = String("/data") + item->pathData;
+	return path.substring(0, path.length() - 5) + ".runs";
+}
+// "/result/name.json" => "/data/result/name.bin", the SampleLog of its last run
+String logPath(HistoryItem *item)
+{
+	String path = String("/data") + item->pathData;
+	return path.substring(0, path.length() - 5) + ".bin";
+}
+// appends the bins of the last test to the runs of item, with the test below.
+// result is the one of item, with the run
+bool saveRun(HistoryItem *item, DataArray<TestAnalyzer::MAX_RESULT, ResultBin> &result,
+			 const float *distance, const float *force, bool create, uint16_t legacy = 0);
+
 void deleteResult(uint8_t index, AsyncWebSocketClient *client)
 {
 	HistoryItem *item = history[index];
 	if (item)
 	{
 		String file = String("/data") + item->pathData;
+		String runs = runsPath(item);
+		String log = logPath(item);
 
 		if (history.remove(item) && fileManager.deleteFile(file))
 		{
+			if (fileManager.exists(runs))
+				fileManager.deleteFile(runs);
+			if (fileManager.exists(log))
+				fileManager.deleteFile(log);
 			if (fileManager.writeJson("/data/results.json", &history))
 			{
 				server.sendMessage(ServerManager::GOOD, "result deleted", client);
@@ -221,6 +303,7 @@ void saveResult(JsonObject &obj, AsyncWebSocketClient *client)
 			strcpy(item->description, obj["desc"]);
 			item->area = obj["area"];
 			item->length = obj["length"];
+			item->peakStress = item->area > 0 ? item->peakForce / item->area : 0;
 
 			if (fileManager.writeJson("/data/results.json", &history))
 			{
@@ -258,10 +341,16 @@ void renameResult(JsonObject &obj, AsyncWebSocketClient *client)
 			else if (item->isValide(path, name, item->date, item->description))
 			{
 				String old = String("/data") + item->pathData;
+				String oldRuns = runsPath(item);
+				String oldLog = logPath(item);
 				if (fileManager.renameFile(old.c_str(), file.c_str()))
 				{
 					strcpy(item->pathData, path);
 					strcpy(item->name, name);
+					if (fileManager.exists(oldRuns))
+						fileManager.renameFile(oldRuns.c_str(), runsPath(item).c_str());
+					if (fileManager.exists(oldLog))
+						fileManager.renameFile(oldLog.c_str(), logPath(item).c_str());
 					if (fileManager.writeJson("/data/results.json", &history))
 					{
 						String path = String("/result/") + name;
@@ -311,6 +400,8 @@ void newResult(JsonObject &obj, AsyncWebSocketClient *client)
 		const char *description = obj["desc"];
 		float length = obj["length"];
 		float area = obj["area"];
+		// optional, the average by strain of the whole curve
+		uint8_t mode = obj["mode"].is<uint8_t>() && obj["mode"].as<uint8_t>() == HistoryItem::STRAIN ? HistoryItem::STRAIN : HistoryItem::TIME;
 
 		String p = String("/result/") + name + ".json";
 		String file = "/data" + p;
@@ -322,13 +413,51 @@ void newResult(JsonObject &obj, AsyncWebSocketClient *client)
 		}
 		else if (item->isValide(path, name, date, description))
 		{
+			DataArray<TestAnalyzer::MAX_RESULT, ResultBin> *result = &analyzer.accumulated_data;
+			float distance[TestAnalyzer::MAX_RESULT], force[TestAnalyzer::MAX_RESULT];
+			analyzer.resample(distance, force);
+
+			if (mode == HistoryItem::STRAIN)
+			{
+				// the specimen of the run, the one of the new result if the run didn't give it
+				float runLength = testSpecimen ? testLength : length;
+				if (runLength <= 0)
+				{
+					server.sendMessage(ServerManager::ERROR, "no length of the specimen, it can't be averaged by strain", client);
+					return;
+				}
+				// the grid goes a bit further than the break of this run
+				float elongation = analyzer.getProperties(runLength, area).elongation;
+				float step = elongation / runLength * TestAnalyzer::STRAIN_MARGIN / (TestAnalyzer::MAX_RESULT - 1);
+				if (step <= 0)
+				{
+					server.sendMessage(ServerManager::ERROR, "no elongation in the last test, it can't be averaged by strain", client);
+					return;
+				}
+				if (!analyzer.resampleStrain(runLength, step, length, distance, force))
+				{
+					server.sendMessage(ServerManager::ERROR, "the samples of the last test are not saved, it can't be averaged by strain", client);
+					return;
+				}
+				scratchResult.clear();
+				TestAnalyzer::accumulate(scratchResult, TestAnalyzer::Grid::strain(), distance, force);
+				result = &scratchResult;
+			}
+			// the band of its first run
+			for (ResultBin *bin : *result)
+				bin->setBand(bin->force, bin->force, bin->force, 1);
+
 			Serial.printf("new result %s %s\n", file.c_str(), path);
 			//	save result
 			// Serial.printf("%s\n", analyzer.accumulated_data.serializeString().c_str());
-			if (fileManager.writeJson(file.c_str(), &analyzer.accumulated_data))
+			if (fileManager.writeJson(file.c_str(), result))
 			{
 				item->set(path, name, date, description, length, area);
+				item->mode = mode;
+				item->summarize(*result);
 				history.push(item);
+				if (!saveRun(item, *result, distance, force, true))
+					server.sendMessage(ServerManager::WARN, "the run was not saved, the average can't be recomputed", client);
 				if (fileManager.writeJson("/data/results.json", &history))
 				{
 					String path = String("/result/") + name;
@@ -337,7 +466,7 @@ void newResult(JsonObject &obj, AsyncWebSocketClient *client)
 					// TODO crear cmd puto vago
 					//clear result in client 
 					analyzer.clear();
-					server.send(createJsonLastResult(), client);
+					server.send(createJsonLastResult(lastProperties(item)), client);
 					// send all update;
 					clientConnected(nullptr);
 					server.updateJsonFile();
@@ -358,6 +487,7 @@ enum Step
 	STOP = 0,
 	START = 1,
 	MEASURING = 2, // measuring
+	TARE = 3,	   // waiting the tare to start
 };
 Step testStep = STOP;
 enum State
@@ -367,22 +497,89 @@ enum State
 	TESTRUN = 2
 };
 State state = EMPTY;
+bool scaleTared = false; // the first tare done, the overload limit is armed
+void updateTest(const LoadCellSample &sample, int32_t force);
+void beginTest();
+void clearTest();
+
 void setupSensors()
 {
 	scale.begin(LOADCELL_DOUT_PIN, LOADCELL_SCK_PIN);
-	scale.set_scale(CALIBRATING_FACTOR);
-	scale.tare(80);
+	calibration.set(0, CALIBRATING_FACTOR);
+	// from here only the sampler task reads the HX711
+	sampler.setPositionSource([]() { return motor.getPosition(); });
+	// every conversion, in the sampler task
+	sampler.setOnSample([](const LoadCellSample &sample) {
+		int32_t counts = calibration.net(sample.raw);
+		int8_t dir = motor.isRunning() ? motor.getDirection() : 0;
+		bool overloaded = overload.check(counts, dir);
+		bool broken = breakDetector.update(counts, sample.time);
+		if (overloaded || broken)
+			motor.emergencyStop();
+	});
+	sampler.begin(scale, LOADCELL_DOUT_PIN);
+	baseline.setBand(calibration.fromKg(0.05));
+	// the overload limit waits for the boot tare (tareDone), without the
+	// offset net() is the raw count and the zero of the HX711 would trip it
+	tare.start(80, millis());
 }
-void readSensors()
+//		the tare finished, called by readSensors() or updateTare()
+void tareDone()
 {
-	if (scale.is_ready())
+	if (tare.getState() == Tare::DONE)
 	{
-		currentSensor.set(
-			motor.getPosition(),
-			scale.get_units(1));
+		calibration.setOffset(tare.getOffset());
+		forceFilter.reset();
+		if (!scaleTared)
+			overload.setLimit(calibration.fromKg(config.max_force));
+		scaleTared = true;
+		Serial.printf("tare: offset %d\n", tare.getOffset());
+		if (state == TESTRUN && testStep == TARE)
+			beginTest();
+		else
+			server.sendMessage(ServerManager::GOOD, "Tare scale");
 	}
 	else
-		currentSensor.distance = motor.getPosition();
+	{
+		Serial.println("tare: HX711 not responding");
+		server.sendMessage(ServerManager::ERROR, "Tare failed, check HX711");
+		if (state == TESTRUN)
+			clearTest();
+	}
+	tare.clear();
+}
+void updateTare()
+{
+	if (tare.update(millis()))
+		tareDone();
+}
+//		drain all the samples captured by the sampler task
+void readSensors()
+{
+	LoadCellSample sample;
+
+	while (sampler.pop(sample))
+	{
+		// the samples of a tare are not measured
+		if (tare.isRunning())
+		{
+			if (tare.add(sample.raw))
+				tareDone();
+			continue;
+		}
+		// idle, keep the zero up to date
+		if (config.auto_zero && state != State::TESTRUN && !motor.isRunning())
+			baseline.add(sample.raw, millis());
+		else
+			baseline.restart();
+
+		currentCounts = forceFilter.update(calibration.net(sample.raw));
+		currentSensor.distance = sample.position;
+		currentSensor.timestamp = sample.time;
+
+		if (state == State::TESTRUN)
+			updateTest(sample, currentCounts);
+	}
 }
 void updateSensors()
 {
@@ -391,10 +588,23 @@ void updateSensors()
 	{
 		// int t = micros();
 		if (state != State::TESTRUN)
-			readSensors();
+			currentSensor.distance = motor.getPosition();
+		currentSensor.setSample(currentSensor.distance, calibration.toKg(currentCounts), currentSensor.timestamp);
 
 		server.send(createJsonSensors());
 		c = millis();
+
+		// the guard trips in the sampler task, report it from here
+		static uint32_t trips = 0, blocked = 0;
+		if (overload.getTrips() != trips || overload.getBlocked() != blocked)
+		{
+			if (overload.getTrips() != trips)
+				server.sendMessage(ServerManager::ERROR, String("Overload! motor stopped, max force ") +
+															 calibration.toKg(overload.getPeak()) + "kg");
+			trips = overload.getTrips();
+			blocked = overload.getBlocked();
+			server.send(createJsonOverload());
+		}
 		// Serial.printf("readsensor %.2f\n",(micros()-t)/1000.0);
 	}
 }
@@ -496,8 +706,320 @@ float testTriggerWeigth = 0.3; // 0.1 - 5 kg
 float testDist = 5.0;		   // 1 - 10 mm
 float testSpeed = 1.0;		   // 0.1 - 5 kg
 float testAcceleration = 2.0;  // 1 - 10 mm
+StreamFilter::Type testFilter = StreamFilter::NONE;
+uint8_t testFilterSize = 5;	   // samples, 1 - 15
+uint8_t testBreakDrop = 0;	   // % from the peak, 0 disabled
+uint16_t testBreakTime = 100;  // ms
+const uint32_t BREAK_WAIT_TIME = 1000; // ms, at most after a break for the window of the peak
+float testBandLow = 0;		   // kg, fit of the modulus, 0 = 10% of max_force
+float testBandHigh = 0;		   // kg, 0 = 30% of max_force
+
+// thresholds of the running test in net counts, see startTest
+struct TestLimits
+{
+	int32_t trigger;
+	int32_t readyToStop; // 1kg
+	int32_t stop;		 // 0.5kg
+	int32_t maxForce;	 // config.max_force - 2kg
+} testLimits;
+
+bool saveRun(HistoryItem *item, DataArray<TestAnalyzer::MAX_RESULT, ResultBin> &result,
+			 const float *distance, const float *force, bool create, uint16_t legacy)
+{
+	String path = runsPath(item);
+	RunStoreHeader header;
+	// results from before the store (or from another version) start one with their old runs as legacy
+	TestAnalyzer::Grid grid;
+	grid.read(result);
+	if ((create || !runStore.getHeader(path.c_str(), header)) &&
+		!runStore.create(path.c_str(), grid.times, legacy))
+		return false;
+
+	ResultRuns::Record run;
+	memcpy(run.distance, distance, sizeof(run.distance));
+	memcpy(run.force, force, sizeof(run.force));
+	run.filter = testFilter;
+	// the specimen of the run, the one of the result if the run didn't give it
+	run.length = testSpecimen ? testLength : item->length;
+	run.area = testSpecimen ? testArea : item->area;
+	run.speed = testSpeed;
+	run.factor = analyzer.getCalibration().countsPerKg;
+	if (!runStore.append(path.c_str(), run))
+		return false;
+	// the samples of the run next to the result, in place of the ones of the run before
+	analyzer.moveStream(logPath(item).c_str());
+	return true;
+}
+
+String createJsonRuns(uint8_t index, HistoryItem *item)
+{
+	JsonDocument root;
+	String json;
+
+	String path = runsPath(item);
+	RunStoreHeader header;
+	JsonObject obj = root["runs"].to<JsonObject>();
+	obj["id"] = index;
+	obj["legacy"] = runStore.getHeader(path.c_str(), header) ? header.legacy : item->averageCount + 1;
+
+	JsonArray list = obj["list"].to<JsonArray>();
+	runStore.forEach(path.c_str(), [&](uint16_t i, ResultRuns::Record &run)
+	{
+		float peak = 0;
+		for (float force : run.force)
+			peak = std::max(peak, force);
+		JsonObject o = list.add<JsonObject>();
+		o["ex"] = run.isExcluded();
+		o["peak"] = round(peak * 100.0) / 100.0;
+		o["length"] = run.length;
+		o["area"] = run.area;
+		o["speed"] = run.speed;
+	});
+
+	serializeJson(root, json);
+	return json;
+}
+
+// the average of the included runs of a store in result, one pass. The number of runs, -1 without store
+int32_t recomputeRuns(const String &path, DataArray<TestAnalyzer::MAX_RESULT, ResultBin> &result, uint16_t &included)
+{
+	included = 0;
+	result.clear();
+	// the bins of the result, by time or by strain
+	TestAnalyzer::Grid grid;
+	if (!runStore.getTimes(path.c_str(), grid.times))
+		return -1;
+	// and the band, of the last runs
+	OutlierCheck::RunSet *runs = new OutlierCheck::RunSet();
+	int32_t total = runStore.forEach(path.c_str(), [&](uint16_t i, ResultRuns::Record &record)
+	{
+		if (!record.isExcluded())
+		{
+			TestAnalyzer::accumulate(result, grid, record.distance, record.force);
+			runs->add(record.distance, record.force);
+			included++;
+		}
+	});
+	runs->setBand(result);
+	delete runs;
+	return total;
+}
+
+// excludes/includes a run of a result and recomputes the average in one pass
+void setRunExcluded(JsonObject &obj, bool excluded, AsyncWebSocketClient *client)
+{
+	if (!obj["id"].is<uint8_t>() || !obj["run"].is<uint16_t>())
+	{
+		server.sendMessage(ServerManager::ERROR, "error run bad parameter", client);
+		return;
+	}
+	HistoryItem *item = history[obj["id"].as<uint8_t>()];
+	if (!item)
+	{
+		server.sendMessage(ServerManager::ERROR, "error result not found", client);
+		return;
+	}
+
+	String path = runsPath(item);
+	RunStoreHeader header;
+	if (!runStore.getHeader(path.c_str(), header))
+	{
+		server.sendMessage(ServerManager::ERROR, "error runs of the result not found", client);
+		return;
+	}
+	if (header.legacy)
+	{
+		server.sendMessage(ServerManager::ERROR, item->name + String(" was saved before its runs were kept, it can't be recomputed"), client);
+		return;
+	}
+
+	uint16_t run = obj["run"];
+	if (!runStore.setExcluded(path.c_str(), run, excluded))
+	{
+		server.sendMessage(ServerManager::ERROR, "error run not found", client);
+		return;
+	}
+
+	uint16_t included;
+	int32_t total = recomputeRuns(path, scratchResult, included);
+	if (included == 0)
+	{
+		runStore.setExcluded(path.c_str(), run, !excluded);
+		server.sendMessage(ServerManager::ERROR, "at least one run must be in the average", client);
+		return;
+	}
+
+	String file = String("/data") + item->pathData;
+	item->averageCount = included - 1;
+	item->summarize(scratchResult);
+	if (fileManager.writeJson(file.c_str(), &scratchResult) &&
+		fileManager.writeJson("/data/results.json", &history))
+	{
+		server.sendMessage(ServerManager::GOOD,
+						   item->name + String(" average of ") + included + " runs of " + total, client);
+		server.send(createJsonRuns(obj["id"].as<uint8_t>(), item), client);
+		clientConnected(nullptr);
+	}
+	else
+		server.sendMessage(ServerManager::ERROR, "error write result file", client);
+}
+
+// every result rebuilt from its runs by a task of low priority, after a change
+// of the analysis. The task only reads: it hands the results one at a time to
+// loop(), that saves them and updates the history, see updateReprocess().
+// The results can't change meanwhile
+enum ReprocessSlot
+{
+	SLOT_NONE,	  // the result is not found
+	SLOT_KEPT,	  // without runs, the file for its summary
+	SLOT_REBUILT, // from its runs
+};
+struct ReprocessJob
+{
+	volatile bool running = false;
+	volatile bool finished = false;
+	volatile uint8_t done = 0; // results walked by the task
+	uint8_t rebuilt = 0;	   // with a store of runs, the others are kept
+	uint8_t total = 0;
+	uint8_t reported = 0;
+	// the result of the task for loop(), owned by loop() while ready
+	DataArray<TestAnalyzer::MAX_RESULT, ResultBin> *result = nullptr;
+	uint8_t index = 0;
+	uint8_t slot = SLOT_NONE;
+	uint16_t included = 0;
+	std::atomic<bool> ready{false};
+} reprocess;
+
+bool isReprocessing(AsyncWebSocketClient *client)
+{
+	if (reprocess.running)
+	{
+		server.sendMessage(ServerManager::ERROR, String("The results are being reprocessed ") + reprocess.done + "/" + reprocess.total + ", please wait.", client);
+		return true;
+	}
+	return false;
+}
+
+// a result from its runs in result, without writing anything. Without runs
+// the file, for its summary. included: the runs in the average
+ReprocessSlot rebuildResult(HistoryItem *item, DataArray<TestAnalyzer::MAX_RESULT, ResultBin> &result, uint16_t &included)
+{
+	String path = runsPath(item);
+	RunStoreHeader header;
+	if (!runStore.getHeader(path.c_str(), header) || header.legacy)
+		return readResult(item, result) ? SLOT_KEPT : SLOT_NONE;
+
+	recomputeRuns(path, result, included);
+	return included > 0 ? SLOT_REBUILT : SLOT_NONE;
+}
+
+void reprocessTask(void *param)
+{
+	for (uint8_t i = 0; i < reprocess.total; i++)
+	{
+		// the history can't change while the job runs
+		HistoryItem *item = history[i];
+		reprocess.index = i;
+		reprocess.slot = item ? rebuildResult(item, *reprocess.result, reprocess.included) : SLOT_NONE;
+		reprocess.ready.store(true, std::memory_order_release);
+		// loop(), the sampler and the network run until loop() takes it
+		while (reprocess.ready.load(std::memory_order_acquire))
+			vTaskDelay(1);
+		reprocess.done = i + 1;
+	}
+
+	reprocess.finished = true;
+	vTaskDelete(nullptr);
+}
+
+void startReprocess(AsyncWebSocketClient *client)
+{
+	if (history.size() == 0)
+	{
+		server.sendMessage(ServerManager::WARN, "no results to reprocess", client);
+		return;
+	}
+	if (isTestRunning(client))
+		return;
+	// its own result, scratchResult is still used to send the results
+	if (!reprocess.result)
+		reprocess.result = new DataArray<TestAnalyzer::MAX_RESULT, ResultBin>();
+	reprocess.total = history.size();
+	reprocess.done = 0;
+	reprocess.rebuilt = 0;
+	reprocess.reported = 0;
+	reprocess.ready = false;
+	reprocess.finished = false;
+	reprocess.running = true;
+
+	// idle + 1, under loop() and the tasks of the network
+	if (xTaskCreatePinnedToCore(reprocessTask, "reprocess", 8192, nullptr, tskIDLE_PRIORITY + 1, nullptr, 0) != pdPASS)
+	{
+		reprocess.running = false;
+		server.sendMessage(ServerManager::ERROR, "error reprocess task not created", client);
+		return;
+	}
+	server.sendMessageAuth(ServerManager::GOOD, String("reprocessing ") + reprocess.total + " results");
+}
 
-void addAverage(uint8_t index, AsyncWebSocketClient *client)
+// called by loop(): the result handed by the task to its file and
+// the history, and the progress to the auth clients
+void updateReprocess()
+{
+	if (!reprocess.running)
+		return;
+
+	if (reprocess.ready.load(std::memory_order_acquire))
+	{
+		HistoryItem *item = history[reprocess.index];
+		DataArray<TestAnalyzer::MAX_RESULT, ResultBin> &result = *reprocess.result;
+		if (item && reprocess.slot == SLOT_REBUILT)
+		{
+			String file = String("/data") + item->pathData;
+			if (fileManager.writeJson(file.c_str(), &result))
+			{
+				item->averageCount = std::min<uint16_t>(reprocess.included - 1, UINT8_MAX);
+				item->summarize(result);
+				reprocess.rebuilt++;
+			}
+		}
+		else if (item && reprocess.slot == SLOT_KEPT)
+			item->summarize(result);
+		reprocess.ready.store(false, std::memory_order_release);
+	}
+
+	const bool finished = reprocess.finished;
+	const uint8_t done = reprocess.done;
+	if (done != reprocess.reported && !finished)
+	{
+		reprocess.reported = done;
+		server.sendMessageAuth(ServerManager::GOOD, String("reprocessed ") + done + "/" + reprocess.total);
+	}
+	if (!finished)
+		return;
+
+	reprocess.running = false;
+	delete reprocess.result;
+	reprocess.result = nullptr;
+	if (fileManager.writeJson("/data/results.json", &history))
+	{
+		server.sendMessageAuth(ServerManager::GOOD, String("reprocess done, ") + reprocess.rebuilt + " of " + reprocess.total +
+														" results rebuilt from their runs");
+		clientConnected(nullptr);
+	}
+	else
+		server.sendMessageAuth(ServerManager::ERROR, "error write history file");
+}
+
+// check of the run against the result before adding it, see OutlierCheck.h
+enum AverageCheck
+{
+	CHECK_OFF,
+	CHECK_FLAG,
+	CHECK_REJECT
+};
+
+void addAverage(uint8_t index, AsyncWebSocketClient *client, uint8_t check = CHECK_OFF, float limit = 3.5)
 {
 
 	if (analyzer.isEmpty())
@@ -513,30 +1035,107 @@ void addAverage(uint8_t index, AsyncWebSocketClient *client)
 		return;
 	}
 
+	if (item->averageCount == UINT8_MAX)
+	{
+		server.sendMessage(ServerManager::ERROR, "the average is full, exclude some runs", client);
+		return;
+	}
+
 	String path = String("/data") + item->pathData;
 
-	if (!fileManager.readJson(path.c_str(), &analyzer.accumulated_data))
+	if (!readResult(item, analyzer.accumulated_data))
 	{
 		server.sendMessage(ServerManager::ERROR, "error read result file", client);
 		return;
 	}
 
+	float distance[TestAnalyzer::MAX_RESULT], force[TestAnalyzer::MAX_RESULT];
+	TestAnalyzer::Grid grid = TestAnalyzer::Grid::strain();
+	if (item->mode == HistoryItem::STRAIN)
+	{
+		// no peak to align or to check, the grid of the result
+		check = CHECK_OFF;
+		analyzer.setAlign(TestAnalyzer::ALIGN_PEAK);
+		// the specimen of the run, the one of the result if the run didn't give it
+		float runLength = testSpecimen ? testLength : item->length;
+		float step = TestAnalyzer::strainStep(analyzer.accumulated_data, item->length);
+		if (runLength <= 0 || !analyzer.resampleStrain(runLength, step, item->length, distance, force))
+		{
+			analyzer.clear();
+			analyzer.addTest(0);
+			server.sendMessage(ServerManager::ERROR, runLength <= 0 ? "no length of the specimen, it can't be averaged by strain"
+																	: "the samples of the last test are not saved, it can't be averaged by strain",
+							   client);
+			return;
+		}
+	}
+	else
+	{
+		analyzer.resample(distance, force);
+		grid = analyzer.getGrid();
+	}
+
+	// the runs of the result, for the check and the band
+	OutlierCheck::RunSet *runs = new OutlierCheck::RunSet();
+	RunStoreHeader header;
+	bool legacy = !runStore.getHeader(runsPath(item).c_str(), header) || header.legacy;
+	runStore.forEach(runsPath(item).c_str(), [&](uint16_t i, ResultRuns::Record &record)
+	{
+		if (!record.isExcluded())
+			runs->add(record.distance, record.force);
+	});
+
+	OutlierReport report;
+	if (check != CHECK_OFF)
+	{
+		// against the runs of the result, or its band if they are not kept
+		if (runs->runs >= OutlierCheck::MIN_RUNS)
+			report = OutlierCheck::check(*runs, distance, force, limit);
+		else
+			report = OutlierCheck::check(analyzer.accumulated_data, distance, force, limit);
+		if (report.outlier && check == CHECK_REJECT)
+		{
+			delete runs;
+			// the last result again, it can still be saved as a new one
+			analyzer.clear();
+			analyzer.addTest(0);
+			server.sendMessage(ServerManager::WARN, String("run rejected, outlier: ") + report.toString(), client);
+			return;
+		}
+	}
+
 	// Increment the counter of processed series
-	analyzer.addTest(++item->averageCount);
+	// a result by strain has all its bins, the grid is only for old files by time
+	TestAnalyzer::accumulate(analyzer.accumulated_data, grid, distance, force);
+	item->averageCount++;
+	item->summarize(analyzer.accumulated_data);
+	// the band of the runs, a result with runs that are not kept keeps the
+	// one of its file until it has enough of them
+	runs->add(distance, force);
+	if (!legacy || runs->runs >= OutlierCheck::MIN_RUNS)
+		runs->setBand(analyzer.accumulated_data);
+	delete runs;
 
 	// save result
 	if (fileManager.writeJson(path.c_str(), &analyzer.accumulated_data))
 	{
+		// the runs in the summary before this one, if the store is new
+		if (!saveRun(item, analyzer.accumulated_data, distance, force, false, item->averageCount))
+			server.sendMessage(ServerManager::WARN, "the run was not saved, the average can't be recomputed", client);
 		// save history
 		if (fileManager.writeJson("/data/results.json", &history))
 		{
 			String url = String("/result/") + item->name;
 			server.goTo(url.c_str(), client);
-			server.sendMessage(ServerManager::GOOD,
-							   item->name + String(" Update Average n° ") + (item->averageCount + 1), client);
+			String msg = item->name + String(" Update Average n° ") + (item->averageCount + 1);
+			if (check != CHECK_OFF)
+				msg += (report.outlier ? String(", outlier: ") : String(", ")) + report.toString();
+			if (analyzer.getAlign() == TestAnalyzer::ALIGN_XCORR)
+				msg += String(", shift ") + analyzer.getAlignShift() + " ms";
+			server.sendMessage(report.outlier ? ServerManager::WARN : ServerManager::GOOD, msg, client);
 			// clear result in client
 			analyzer.clear();// TODO crear cmd puto vago
-			server.send(createJsonLastResult(), client);
+			server.send(createJsonLastResult(lastProperties(item)), client);
 			// send all update;
 			clientConnected(nullptr);
 		}
@@ -549,101 +1148,149 @@ void addAverage(uint8_t index, AsyncWebSocketClient *client)
 
 void startTest()
 {
-	Serial.printf("run test %.2f %.2f\n", testDist, testTriggerWeigth);
+	Serial.printf("run test %.2f %.2f filter %d/%d\n", testDist, testTriggerWeigth, testFilter, testFilterSize);
 	analyzer.clear();
 	analyzer.clearData();
+	// the whole test is saved, the RAM only keeps a window. Moved to the
+	// result it's saved in, the next test overwrites a test not saved
+	analyzer.setStream("/data/last_test.bin");
 	state = TESTRUN;
+
+	// a recent zero at rest, no need to wait a tare
+	if (config.auto_zero && baseline.isFresh(millis(), BASELINE_MAX_AGE))
+	{
+		calibration.setOffset(baseline.getOffset());
+		beginTest();
+	}
+	else
+	{
+		testStep = TARE;
+		tare.start(10, millis());
+	}
+}
+//		the zero is ready, the motor moves until the trigger
+void beginTest()
+{
+	analyzer.setCalibration(calibration);
+	// without the length of the run no yield until the result is saved
+	analyzer.setSpecimen(testSpecimen ? testLength : 0,
+						 testBandLow > 0 ? testBandLow : config.max_force * 0.1f,
+						 testBandHigh > 0 ? testBandHigh : config.max_force * 0.3f);
+	analyzer.setBand(config.band_before, config.band_after);
+	forceFilter.begin(testFilter, testFilterSize);
+	testLimits.trigger = calibration.fromKg(testTriggerWeigth);
+	testLimits.readyToStop = calibration.fromKg(1.0);
+	testLimits.stop = calibration.fromKg(0.5);
+	testLimits.maxForce = calibration.fromKg(config.max_force - 2);
 	testStep = START;
-	scale.tare(10);
 
 	motor.setSpeedAcceleration(testSpeed * 2, testAcceleration);
 	motor.jogging();
 }
 void clearTest()
 {
+	analyzer.endStream();
+	breakDetector.disarm();
+	forceFilter.begin(StreamFilter::NONE, 0);
 	motor.setSpeedAcceleration(config.speed, config.acc_desc);
 	state = EMPTY;
 	testReadyToStop = false;
 	testStep = STOP;
 }
-void updateTest()
+//		called for every sample captured while the test runs
+//		force in net counts, the limits are converted in startTest
+void updateTest(const LoadCellSample &sample, int32_t force)
 {
-	static uint32_t currentTime = 0;
 	static float zeroPos = 0.0;
-	static int32_t zeroTime = 0;
+	static int64_t zeroTime = 0;
 	static uint8_t count = 0;
 
-	if (millis() - currentTime > TestAnalyzer::TEST_STEP_TIME)
+	float pos = sample.position;
+
+	switch (testStep)
 	{
-		currentTime = millis();
+	case TARE:
+		// the samples go to the tare, see readSensors()
+		break;
+	case START:
+		// keep the last seconds, the toe of the curve is before the trigger
+		analyzer.addPreTrigger(pos, force, sample.time);
+
+		if (force >= testLimits.trigger)
+		{
+			motor.setSpeedAcceleration(testSpeed, testAcceleration);
+			motor.move(testDist);
+			testStep = MEASURING;
+			zeroTime = sample.time;
+			zeroPos = pos;
+			analyzer.trigger(zeroPos, zeroTime);
+			if (testBreakDrop > 0)
+				breakDetector.arm(testBreakDrop, testBreakTime, testLimits.readyToStop);
+			Serial.printf("Test started: weight %.2fkg, position %.2fmm\n", calibration.toKg(force), pos);
+			Serial.printf("Trigger weight: %.2fkg\n", testTriggerWeigth);
+		}
+		break;
 
-		readSensors();
+	case MEASURING:
+		if (!analyzer.addRaw(pos - zeroPos, force, sample.time - zeroTime))
+		{
+			Serial.println("Error: Sensor data overflow");
+			server.sendMessage(ServerManager::ERROR, "The flash is full");
+			clearTest();
+			motor.goHome();
+			return;
+		}
 
-		float force = currentSensor.force;
-		float pos = currentSensor.distance;
+		// Prepare to stop if force exceeds threshold
+		if (force > testLimits.readyToStop && !testReadyToStop)
+			testReadyToStop = true;
 
-		switch (testStep)
-		{
-		case START:
-			if (force >= testTriggerWeigth)
-			{
-				motor.setSpeedAcceleration(testSpeed, testAcceleration);
-				motor.move(testDist);
-				testStep = MEASURING;
-				zeroTime = 0;
-				zeroPos = pos;
-				Serial.printf("Test started: weight %.2fkg, position %.2fmm\n", force, pos);
-				Serial.printf("Trigger weight: %.2fkg\n", testTriggerWeigth);
-			}
-			break;
+		// the sampler task has already stopped the motor, wait the samples of
+		// the end of the rupture window and the room of the alignment after it
+		bool broken = breakDetector.hasTripped() && sample.time >= breakDetector.getTripTime();
+		bool windowReady = analyzer.isAlignReady() ||
+						   sample.time > breakDetector.getTripTime() + BREAK_WAIT_TIME * 1000LL;
+		if (breakDetector.hasTripped() && !(broken && windowReady))
+			return;
 
-		case MEASURING:
-			zeroTime += TestAnalyzer::TEST_STEP_TIME;
+		bool shouldStop = (testReadyToStop && force < testLimits.stop);
+		bool exceededMaxForce = (force > testLimits.maxForce);
+		bool motionEnded = motor.isMotionEnd();
 
-			if (!analyzer.addPoint(pos - zeroPos, force, zeroTime))
+		if (exceededMaxForce || motionEnded || shouldStop || broken)
+		{
+			if (shouldStop && !broken && count < 1)
 			{
-				Serial.println("Error: Sensor data overflow");
-				server.sendMessage(ServerManager::ERROR, "The time has run out");
-				clearTest();
-				motor.goHome();
+				count++;
 				return;
 			}
 
-			// Prepare to stop if force exceeds threshold
-			if (force > 1.0 && !testReadyToStop)
-				testReadyToStop = true;
+			Serial.println("Test finished:");
+			if (broken)
+				Serial.printf("\n Break detected: %.2fkg, %.1fms after the trigger\n",
+							  calibration.toKg(breakDetector.getTripForce()),
+							  (breakDetector.getTripTime() - zeroTime) / 1000.0);
+			if (exceededMaxForce)
+				Serial.println("\n Exceeded max force \n");
+			if (motionEnded)
+				Serial.println("\n Test Motion ended \n");
 
-			bool shouldStop = (testReadyToStop && force < 0.5);
-			bool exceededMaxForce = (force > config.max_force - 2);
-			bool motionEnded = motor.isMotionEnd();
+			Serial.printf("Force dropped below threshold: %d (force: %.2fkg)\n",
+				 shouldStop, calibration.toKg(force));
 
-			if (exceededMaxForce || motionEnded || shouldStop)
-			{
-				if (shouldStop && count < 1)
-				{
-					count++;
-					return;
-				}
-
-				Serial.println("Test finished:");
-				if (exceededMaxForce)
-					Serial.println("\n Exceeded max force \n");
-				if (motionEnded)
-					Serial.println("\n Test Motion ended \n");
-
-				Serial.printf("Force dropped below threshold: %d (force: %.2fkg)\n",
-					 shouldStop, force);
-
-				clearTest();
-				motor.goHome();
-				analyzer.addTest();
-				server.send(createJsonLastResult());
-				server.goTo("/result/n");
-				server.sendMessage(ServerManager::GOOD, "Test finished successfully!");
-				count = 0;
-			}
-			break;
+			clearTest();
+			motor.goHome();
+			analyzer.addTest();
+			TestProperties props = lastProperties();
+			Serial.printf("Peak %.1fN %.2fMPa, E %.0fMPa, yield %.1fN, elongation %.3fmm, energy %.4fJ\n",
+						  props.peakForce, props.peakStress, props.modulus,
+						  props.yieldForce, props.elongation, props.energy);
+			server.send(createJsonLastResult());
+			server.goTo("/result/n");
+			server.sendMessage(ServerManager::GOOD, "Test finished successfully!");
+			count = 0;
 		}
+		break;
 	}
 }
 
@@ -710,9 +1357,24 @@ void receivedConfig(AsyncWebSocketClient *client, JsonObject &root)
 		}
 
 		config.setHome(newPos, root["max_travel"], root["max_force"]);
+		if (scaleTared)
+			overload.setLimit(calibration.fromKg(config.max_force));
 		defaultConfigMotor();
 		modified = true;
 	}
+	if (root["auto_zero"].is<bool>())
+	{
+		config.auto_zero = root["auto_zero"];
+		baseline.reset();
+		modified = true;
+	}
+	// the next results, a result keeps the grid it was created on
+	if (root["band_before"].is<uint16_t>() && root["band_after"].is<uint16_t>())
+	{
+		config.band_before = root["band_before"];
+		config.band_after = root["band_after"];
+		modified = true;
+	}
 
 	if (modified)
 	{
@@ -726,6 +1388,19 @@ void receivedConfig(AsyncWebSocketClient *client, JsonObject &root)
 			server.sendMessage(ServerManager::ERROR, "error write config file", client);
 	}
 }
+// the commands that can't run while the results are reprocessed: they change
+// the results or their runs, or start a test, a calibration or a tare
+bool isReprocessLocked(JsonObject &root)
+{
+	static const char *keys[] = {"reprocess", "delete", "new", "save", "rename",
+								 "add_avg", "exclude_run", "include_run",
+								 "run", "calibrate", "tare"};
+	for (const char *key : keys)
+		if (!root[key].isNull())
+			return true;
+	return false;
+}
+
 void receivedCmd(AsyncWebSocketClient *client, JsonObject &root)
 {
 
@@ -735,6 +1410,9 @@ void receivedCmd(AsyncWebSocketClient *client, JsonObject &root)
 		clearTest();
 		server.sendMessage(ServerManager::WARN, "Stop emergency!!", client);
 	}
+	// the results don't change while they are reprocessed
+	else if (isReprocessLocked(root) && isReprocessing(client))
+		return;
 	// el test
 	else if (root["move"].is<JsonObject>())
 	{
@@ -782,6 +1460,46 @@ void receivedCmd(AsyncWebSocketClient *client, JsonObject &root)
 		if (obj["dist"].is<float>() && obj["trigger"].is<float>() &&
 			obj["speed"].is<float>() && obj["acc_desc"].is<float>())
 		{
+			// optional filter of the force, "none" "median" "iir" "fir"
+			StreamFilter::Type filter = StreamFilter::NONE;
+			uint8_t filterSize = 5;
+			if (obj["filter_size"].is<uint8_t>())
+				filterSize = obj["filter_size"];
+			if (obj["filter"].is<const char *>() &&
+				!StreamFilter::parseType(obj["filter"], filter))
+			{
+				server.sendMessage(ServerManager::ERROR, "Unknown filter", client);
+				return;
+			}
+			if (filter != StreamFilter::NONE && (filterSize < 1 || filterSize > StreamFilter::MAX_SIZE))
+			{
+				server.sendMessage(ServerManager::ERROR, "Filter size out of range (1-15)", client);
+				return;
+			}
+			testFilter = filter;
+			testFilterSize = filterSize;
+			// optional break detector, off unless the run asks for it:
+			// drop in % (0 off) within break_time ms (max 400)
+			testBreakDrop = 0;
+			testBreakTime = 100;
+			if (obj["break_drop"].is<uint8_t>())
+				testBreakDrop = std::min<uint8_t>(obj["break_drop"].as<uint8_t>(), 99);
+			if (obj["break_time"].is<uint16_t>())
+				testBreakTime = std::min<uint16_t>(obj["break_time"].as<uint16_t>(), 400);
+			// optional specimen (mm, mm2) and band of the modulus (kg)
+			testSpecimen = obj["length"].is<float>() && obj["area"].is<float>();
+			if (testSpecimen)
+			{
+				testLength = obj["length"];
+				testArea = obj["area"];
+			}
+			testBandLow = testBandHigh = 0;
+			if (obj["band_low"].is<float>() && obj["band_high"].is<float>() &&
+				obj["band_low"].as<float>() < obj["band_high"].as<float>())
+			{
+				testBandLow = obj["band_low"];
+				testBandHigh = obj["band_high"];
+			}
 			testDist = obj["dist"];
 			testTriggerWeigth = obj["trigger"];
 			testSpeed = obj["speed"];
@@ -823,10 +1541,11 @@ void receivedCmd(AsyncWebSocketClient *client, JsonObject &root)
 	{
 		if (motor.isRunning())
 			server.sendMessage(ServerManager::ERROR, "First stop motor", client);
-		else
+		else if (!isTestRunning(client) && !tare.isRunning())
 		{
-			scale.tare(80);
-			server.sendMessage(ServerManager::GOOD, "Tare scale", client);
+			// the result is sent by tareDone()
+			tare.start(80, millis());
+			baseline.reset();
 		}
 	}
 	else if (root["restar"].is<uint8_t>())
@@ -834,6 +1553,10 @@ void receivedCmd(AsyncWebSocketClient *client, JsonObject &root)
 		server.sendMessage(ServerManager::ERROR, "Rebooting Esp32", client);
 		ESP.restart();
 	}
+	else if (root["reprocess"].is<uint8_t>())
+	{
+		startReprocess(client);
+	}
 	else if (root["delete"].is<uint8_t>())
 	{
 		uint8_t id = root["delete"];
@@ -857,8 +1580,43 @@ void receivedCmd(AsyncWebSocketClient *client, JsonObject &root)
 	else if (root["add_avg"].is<uint8_t>())
 	{
 		uint8_t id = root["add_avg"];
+		analyzer.setAlign(TestAnalyzer::ALIGN_PEAK);
 		addAverage(id, client);
 	}
+	// {id, check: 1 flag / 2 reject the outliers, z: limit of the robust z,
+	//  align: 0 peak / 1 cross-correlation with the result}
+	else if (root["add_avg"].is<JsonObject>())
+	{
+		JsonObject m = root["add_avg"].as<JsonObject>();
+		if (m["id"].is<uint8_t>())
+		{
+			analyzer.setAlign(m["align"].is<uint8_t>() && m["align"].as<uint8_t>() == 1 ? TestAnalyzer::ALIGN_XCORR : TestAnalyzer::ALIGN_PEAK);
+			uint8_t check = m["check"].is<uint8_t>() ? std::min<uint8_t>(m["check"].as<uint8_t>(), CHECK_REJECT) : uint8_t(CHECK_FLAG);
+			float limit = m["z"].is<float>() ? std::max(m["z"].as<float>(), 1.0f) : 3.5f;
+			addAverage(m["id"].as<uint8_t>(), client, check, limit);
+		}
+		else
+			server.sendMessage(ServerManager::ERROR, "error add_avg bad parameter", client);
+	}
+	else if (root["runs"].is<uint8_t>())
+	{
+		uint8_t id = root["runs"];
+		HistoryItem *item = history[id];
+		if (item)
+			server.send(createJsonRuns(id, item), client);
+		else
+			server.sendMessage(ServerManager::ERROR, "error result not found", client);
+	}
+	else if (root["exclude_run"].is<JsonObject>())
+	{
+		JsonObject m = root["exclude_run"].as<JsonObject>();
+		setRunExcluded(m, true, client);
+	}
+	else if (root["include_run"].is<JsonObject>())
+	{
+		JsonObject m = root["include_run"].as<JsonObject>();
+		setRunExcluded(m, false, client);
+	}
 }
 
 bool lock = false;
@@ -930,22 +1688,21 @@ void startWebServer()
 	Serial.println("started WebServer");
 }
 
+void onNetworkStatus(NetworkManager::Status status)
+{
+	if (status == NetworkManager::CONNECTED)
+		server.sendMessage(ServerManager::GOOD, "Wifi connected");
+	else if (status == NetworkManager::FAILED)
+		server.sendMessage(ServerManager::ERROR, "Wifi not connected");
+}
 void update()
 {
-	static uint32_t c = 0;
-	// cada 5s comprobamos si es necesario reiniciar wifi :/
-	if (resetWifi && millis() - c > 5000 && !lock)
+	// new credentials, the result comes by onNetworkStatus()
+	if (resetWifi && !lock)
 	{
-		c = millis();
 		server.sendMessage(ServerManager::ERROR, "Restarting wifi");
-		network.disconnect();
-		delay(1000);
 		resetWifi = false;
 		network.connect(config.wifi_ssid, config.wifi_pass);
-		if (network.isConnected())
-			server.sendMessage(ServerManager::GOOD, "Wifi connected");
-		else
-			server.sendMessage(ServerManager::ERROR, "Wifi not connected");
 	}
 }
 
@@ -972,13 +1729,15 @@ void setup()
 	// printJsonConfig();
 	// printJsonHistory();
 
-	setupSensors();
+	// the sampler latches the motor position, start the motor first
 	setupMotor();
+	setupSensors();
 
+	// the softAP and the web server are up at once, the STA joins in update()
 	network.begin(hostName);
-	network.connect(config.wifi_ssid, config.wifi_pass);
-
+	network.setOnStatus(onNetworkStatus);
 	startWebServer();
+	network.connect(config.wifi_ssid, config.wifi_pass);
 }
 //		loop
 void loop()
@@ -986,8 +1745,9 @@ void loop()
 	motor.checkLimit();
 	server.update();
 	network.update();
-	if (state == TESTRUN)
-		updateTest();
+	readSensors();
+	updateTare();
 	updateSensors();
+	updateReprocess();
 	update();
 }
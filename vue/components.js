@@ -21,6 +21,50 @@ const mixinNotify = {
   },
 };
 
+// dataset de una linea de los graficos
+function makeDataSet(
+  label,
+  data,
+  borderColor,
+  backgroundColor,
+  pointStyle = true,
+  fill = false
+) {
+  return {
+    label: label,
+    data: data,
+    borderColor: borderColor,
+    backgroundColor: backgroundColor,
+    fill: fill,
+    lineTension: 0.2,
+    pointRadius: 3,
+    pointHoverRadius: 8,
+    pointStyle: pointStyle ? "circle" : false,
+  };
+}
+
+// banda P10-P90 (dos lineas rellenas entre ellas), la misma en los graficos
+function bandDataSets(arrP10, arrP90) {
+  return [
+    makeDataSet(
+      "P90",
+      arrP90,
+      "rgba(75, 192, 192, 0.8)",
+      "rgba(75, 192, 192, 0.2)",
+      false,
+      "+1"
+    ),
+    makeDataSet(
+      "P10",
+      arrP10,
+      "rgba(75, 192, 192, 0.8)",
+      "rgba(75, 192, 192, 0.2)",
+      false,
+      "-1"
+    ),
+  ];
+}
+
 //vue components
 Vue.component("b-sensor", {
   props: ["prop", "value"],
@@ -85,18 +129,11 @@ Vue.component("compare-chart", {
 
       const labels = this.rawData.map((item) => item.name);
 
+      // el resumen del historial (pico, rotura), en tiempo o en deformacion
       const dValues = this.rawData.map((item) =>
-        (
-          (item.data.find((entry) => entry.t === 0).d / item.length) *
-          100
-        ).toFixed(3)
-      );
-      const fValues = this.rawData.map((item) =>
-        (
-          (item.data.find((entry) => entry.t === 0).f * 9.91) /
-          item.area
-        ).toFixed(2)
+        ((item.break_d / item.length) * 100).toFixed(3)
       );
+      const fValues = this.rawData.map((item) => item.peak_s.toFixed(2));
 
       const datasets = [
         {
@@ -113,6 +150,20 @@ Vue.component("compare-chart", {
         },
       ];
 
+      // banda P10-P90 del pico de cada resultado (N/mm2)
+      const peaks = this.rawData.map((item) =>
+        item.data.reduce((a, b) => (b.f > a.f ? b : a))
+      );
+      if (peaks.length && peaks.every((bin) => bin.p10 !== undefined)) {
+        const stress = (item, f) => ((f * 9.81) / item.area).toFixed(2);
+        datasets.push(
+          ...bandDataSets(
+            peaks.map((bin, i) => stress(this.rawData[i], bin.p10)),
+            peaks.map((bin, i) => stress(this.rawData[i], bin.p90))
+          ).map((dataset) => ({ ...dataset, type: "line" }))
+        );
+      }
+
       // Actualizar chartData
       this.chartData = {
         labels: labels,
@@ -176,26 +227,7 @@ Vue.component("result-chart", {
     this.renderChart(this.chartData, this.options);
   },
   methods: {
-    makeDataSet(
-      label,
-      data,
-      borderColor,
-      backgroundColor,
-      pointStyle = true,
-      fill = false
-    ) {
-      return {
-        label: label,
-        data: data,
-        borderColor: borderColor,
-        backgroundColor: backgroundColor,
-        fill: fill,
-        lineTension: 0.2,
-        pointRadius: 3,
-        pointHoverRadius: 8,
-        pointStyle: pointStyle ? "circle" : false,
-      };
-    },
+    makeDataSet,
     updateChart() {
       // Crear labels y datos
       const arrTime = this.rawData.map((item) => item.d); // Tiempo (eje X)
@@ -228,6 +260,16 @@ Vue.component("result-chart", {
         ),
       ];
 
+      // banda P10-P90, robusta a los outliers (resultados con varios ensayos)
+      if (this.rawData.length && this.rawData[0].p10 !== undefined) {
+        datasets.push(
+          ...bandDataSets(
+            this.rawData.map((item) => ({ x: item.d, y: item.p10 })),
+            this.rawData.map((item) => ({ x: item.d, y: item.p90 }))
+          )
+        );
+      }
+
       // Actualizar chartData
       this.chartData = {
         labels: arrTime,
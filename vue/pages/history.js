@@ -6,11 +6,26 @@ const pageHistory = {
         chardata: [],
         historyLen:0,
         log: "",
+        sortBy: "name",
+        sortOptions: [
+          { label: "Name", value: "name" },
+          { label: "Peak force", value: "peak_f" },
+          { label: "Peak stress", value: "peak_s" },
+          { label: "Break", value: "break_d" },
+          { label: "Energy", value: "energy" },
+        ],
       };
     },
     computed: {
       ...Vuex.mapState(["history", "results", "authenticate"]),
       ...Vuex.mapGetters(["getHistoryIndex"]),
+      // the summary is in the history, no result file is loaded
+      sortedHistory() {
+        const key = this.sortBy;
+        return [...this.history].sort((a, b) =>
+          key === "name" ? a.name.localeCompare(b.name) : (b[key] || 0) - (a[key] || 0)
+        );
+      },
     },
     methods: {
       ...Vuex.mapActions(["loadResults", "sendCmd"]),
@@ -32,6 +47,11 @@ const pageHistory = {
             delete: index,
           });
       },
+      reprocess() {
+        this.sendCmd({
+          reprocess: 1,
+        });
+      },
       editItem(name) {
         this.log = name;
         this.$router.push({ path: `/result/${name}` });
@@ -85,13 +105,20 @@ const pageHistory = {
           
       </b-container>
       <b-container :title="'Manage Results ('+ history.length + '/20)'">
+          <q-select filled dense class="q-mb-sm" label="Sort by"
+            v-model="sortBy" :options="sortOptions"
+            emit-value map-options />
           <q-list bordered >
             <transition-group name="list-complete">
-              <q-item v-for="result in history" :key="result.name"
+              <q-item v-for="result in sortedHistory" :key="result.name"
                 v-ripple class="list-complete-item"
               >
                 <q-item-section>
                   <q-item-label>{{ result.name }}</q-item-label>
+                  <q-item-label caption v-if="result.peak_f">
+                    {{ result.peak_f }}N ±{{ result.peak_sd }}, {{ result.peak_s }}MPa,
+                    break {{ result.break_d }}mm, {{ result.energy }}J
+                  </q-item-label>
                 </q-item-section>
                 <q-item-section side>
                   <div class=" q-gutter-sm text-white" style="display:flex;">
@@ -108,6 +135,11 @@ const pageHistory = {
               </q-item>
             </transition-group>
           </q-list>
+          <div v-if="authenticate" class="row justify-end q-mt-sm">
+            <q-btn label="Reprocess all" class="bg-primary text-white"
+              @click="reprocess()"
+            />
+          </div>
       </b-container>
     </q-page>
   `};
\ No newline at end of file
@@ -7,6 +7,7 @@ const pageResult = {
       avgCount: 0,
       length: 5,
       area: 2,
+      strainMode: false,
       id: -1,
       chardata: [],
       isNew: false,
@@ -44,7 +45,8 @@ const pageResult = {
             date: this.date,
             desc: this.description,
             length: this.length,
-            area: this.area
+            area: this.area,
+            mode: this.strainMode ? 1 : 0
           },
         });
       } else if (this.isNew) {
@@ -163,12 +165,10 @@ const pageResult = {
       this.avgCount = doc.avg_count + 1;
       this.length = doc.length;
       this.area = doc.area;
-      const item_break = this.chardata.find(item => item.t === 0);
-      if (item_break) {
-        this.elongation = Math.round(item_break.d / this.length* 10000) / 100;
-        this.strain = Math.round(item_break.f * 9.91/ this.area * 100) / 100;
-        this.force = Math.round(item_break.f * 9.91 * 100) / 100;
-      }
+      // el resumen guardado con el resultado, en tiempo o en deformacion
+      this.elongation = Math.round(doc.break_d / this.length * 10000) / 100;
+      this.strain = doc.peak_s;
+      this.force = doc.peak_f;
     },
     //
     description: function (newValue, oldValue) {
@@ -244,6 +244,9 @@ const pageResult = {
                 </div>
               </div>
 
+              <q-toggle v-if="authenticate && isNew && mt === 'New'"
+                v-model="strainMode" label="Average by strain (whole curve)" />
+
               <q-select filled v-if="authenticate && isNew" 
                 class="q-py-md" 
                 v-model="mt" :options="mOptions" label="Update Average" />